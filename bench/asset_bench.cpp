@@ -0,0 +1,207 @@
+//
+// Created by andy on 7/8/2025.
+//
+
+// AssetManager loads, lookups and gc cycles, and the reference counting every AssetRef copy pays. The assets are small json files written to the harness's scratch
+// directory, loaded by a loader that needs no render system, so these measure the manager rather than vulkan.
+
+#include "harness.hpp"
+
+#include "game/asset/asset_manager.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <latch>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace game {
+    namespace bench {
+        namespace {
+            struct BenchAsset final : Asset<BenchAsset> {
+                int value;
+
+                BenchAsset(const int value, const asset_id_t id, const std::string &name) : Asset(id, name), value(value) {}
+            };
+
+            struct BenchAssetLoader final : JsonAssetLoader<BenchAsset, std::nullptr_t> {
+                BenchAsset *load(const nlohmann::json &json, const std::nullptr_t &, const asset_id_t id, const std::string &name, const AssetLoaderContext &) const override {
+                    return new BenchAsset(json.at("value").get<int>(), id, name);
+                }
+            };
+
+            constexpr std::size_t ASSET_COUNT   = 256;
+            constexpr std::size_t REF_BATCH     = 1 << 16;
+            constexpr unsigned    REF_THREADS   = 4;
+            constexpr std::size_t THREAD_BATCH  = 1 << 14;
+            constexpr std::size_t LOOKUP_ROUNDS = 16; // passes over the assets per lookup sample
+
+            std::vector<std::string> writeAssets(const std::filesystem::path &root) {
+                std::filesystem::create_directories(root / "assets" / "bench");
+                std::vector<std::string> paths;
+                for (std::size_t i = 0; i < ASSET_COUNT; i++) {
+                    auto path = "bench/asset_" + std::to_string(i) + ".json";
+                    std::ofstream(root / "assets" / path) << nlohmann::json{{"type", "bench"}, {"value", i}, {"tags", {"bench", "generated"}}}.dump(4);
+                    paths.push_back(std::move(path));
+                }
+                return paths;
+            }
+
+            /**
+             * @brief Run deletion steps the way the frame loop does until every asset is gone
+             */
+            void collectAll(AssetManager &manager, const std::vector<std::string> &paths) {
+                const auto anyLoaded = [&] { return std::ranges::any_of(paths, [&](const std::string &path) { return manager.hasAsset(AssetNameView(path)); }); };
+                while (anyLoaded()) {
+                    manager.startDeletionCycle();
+                    std::this_thread::sleep_for(std::chrono::microseconds(100)); // about a frame's worth of work for the gc thread to pick the cycle up
+                    manager.deleteWaitingAssets();
+                }
+            }
+
+            std::vector<AssetRef<BenchAsset>> loadAll(AssetManager &manager, const std::vector<std::string> &paths) {
+                std::vector<AssetRef<BenchAsset>> refs;
+                refs.reserve(paths.size());
+                for (const auto &path : paths) {
+                    refs.push_back(manager.loadFromFile<BenchAssetLoader>(path));
+                }
+                return refs;
+            }
+
+            void managerBenchmarks(Harness &harness, AssetManager &manager, const std::vector<std::string> &paths) {
+                harness.run("asset_manager/load", paths.size(), [&] {
+                    const auto start = std::chrono::steady_clock::now();
+                    auto       refs  = loadAll(manager, paths);
+                    const auto end   = std::chrono::steady_clock::now();
+                    refs.clear();
+                    collectAll(manager, paths);
+                    return end - start;
+                });
+
+                // from dropping the last references to the assets being deleted, including the hand off to the gc thread and back
+                harness.run("asset_manager/gc_cycle", paths.size(), [&] {
+                    auto refs = loadAll(manager, paths);
+                    refs.clear();
+                    const auto start = std::chrono::steady_clock::now();
+                    manager.startDeletionCycle();
+                    while (manager.hasAsset(AssetNameView(paths.back()))) {
+                        manager.deleteWaitingAssets();
+                    }
+                    const auto end = std::chrono::steady_clock::now();
+                    collectAll(manager, paths); // in case the cycle missed any
+                    return end - start;
+                });
+
+                const auto refs = loadAll(manager, paths);
+
+                harness.measure("asset_manager/load_cached", paths.size(), [&, i = std::size_t{0}]() mutable {
+                    doNotOptimize(manager.loadFromFile<BenchAssetLoader>(paths[i++ % paths.size()]));
+                });
+
+                harness.measure("asset_manager/get_by_name", paths.size() * LOOKUP_ROUNDS, [&, i = std::size_t{0}]() mutable {
+                    doNotOptimize(manager.get<BenchAsset>(AssetNameView(paths[i++ % paths.size()])));
+                });
+
+                std::vector<asset_id_t> ids;
+                for (const auto &ref : refs) {
+                    ids.push_back(ref->handle().id);
+                }
+                harness.measure("asset_manager/get_by_id", ids.size() * LOOKUP_ROUNDS, [&, i = std::size_t{0}]() mutable {
+                    doNotOptimize(manager.get<BenchAsset>(ids[i++ % ids.size()]));
+                });
+            }
+
+            /**
+             * @brief Every thread copying and dropping references to the same asset, which is what a popular texture or shader sees when several loaders reference it at
+             * once
+             */
+            void contendedCopies(Harness &harness, const std::string &name, const AssetRef<BenchAsset> &ref, const bool deferred) {
+                harness.run(name, THREAD_BATCH * REF_THREADS, [&] {
+                    std::latch                ready(REF_THREADS + 1);
+                    std::latch                go(1);
+                    std::vector<std::jthread> threads;
+                    for (unsigned t = 0; t < REF_THREADS; t++) {
+                        threads.emplace_back([&] {
+                            std::optional<DeferredAssetRefs> deferredRefs;
+                            if (deferred)
+                                deferredRefs.emplace();
+                            ready.count_down();
+                            go.wait();
+                            for (std::size_t i = 0; i < THREAD_BATCH; i++) {
+                                const AssetRef<BenchAsset> copy(ref);
+                                doNotOptimize(copy);
+                            }
+                        });
+                    }
+                    ready.arrive_and_wait();
+                    const auto start = std::chrono::steady_clock::now();
+                    go.count_down();
+                    threads.clear(); // the deferred releases are flushed as each thread exits, so they're timed too
+                    return std::chrono::steady_clock::now() - start;
+                });
+            }
+
+            void refBenchmarks(Harness &harness, const AssetRef<BenchAsset> &ref) {
+                harness.measure("asset_ref/copy_destroy", REF_BATCH, [&] {
+                    const AssetRef<BenchAsset> copy(ref);
+                    doNotOptimize(copy);
+                });
+
+                const GenericAssetRef generic(ref.operator->());
+                harness.measure("asset_ref/generic_copy_destroy", REF_BATCH, [&] {
+                    const GenericAssetRef copy(generic);
+                    doNotOptimize(copy);
+                });
+
+                harness.measure("asset_ref/generic_as", REF_BATCH, [&] { doNotOptimize(generic.as<BenchAsset>()); });
+
+                const auto handle = ref->handle();
+                harness.measure("asset_ref/handle_resolve", REF_BATCH, [&] { doNotOptimize(handle.get()); });
+
+                // what reading an asset from another thread costs without a lock or a reference (see AssetReadGuard), against locking a weak reference
+                const auto weak = ref.weak();
+                harness.measure("asset_ref/guarded_weak_get", REF_BATCH, [&] {
+                    const AssetReadGuard guard;
+                    doNotOptimize(weak.get());
+                });
+                harness.measure("asset_ref/weak_lock", REF_BATCH, [&] { doNotOptimize(weak.lock()); });
+
+                contendedCopies(harness, "asset_ref/contended_copy_destroy_4t", ref, false);
+
+                // the same with releases deferred (see DeferredAssetRefs), once the first copy's release is pending every copy cancels it instead of touching the counter
+                {
+                    DeferredAssetRefs deferredRefs;
+                    harness.measure("asset_ref/deferred_copy_destroy", REF_BATCH, [&] {
+                        const AssetRef<BenchAsset> copy(ref);
+                        doNotOptimize(copy);
+                    });
+                }
+                contendedCopies(harness, "asset_ref/deferred_contended_copy_destroy_4t", ref, true);
+            }
+        } // namespace
+
+        void assetBenchmarks(Harness &harness) {
+            if (!harness.enabled("asset_manager/") && !harness.enabled("asset_ref/"))
+                return;
+
+            // the asset directory is found from the working directory, so this has to happen before anything asks for it
+            std::filesystem::current_path(harness.scratch());
+            const auto paths = writeAssets(harness.scratch());
+
+            AssetManager manager(nullptr);
+            manager.beginDeletionThread();
+
+            managerBenchmarks(harness, manager, paths);
+            {
+                const auto ref = manager.loadFromFile<BenchAssetLoader>(paths.front());
+                refBenchmarks(harness, ref);
+            }
+
+            collectAll(manager, paths);
+            manager.endDeletionThread();
+            manager.finalEndDeletionThread();
+        }
+    } // namespace bench
+} // namespace game
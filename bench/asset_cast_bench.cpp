@@ -0,0 +1,86 @@
+//
+// Created by andy on 6/29/2025.
+//
+
+// Compares the type tag checked asset casts against the dynamic_cast they replaced, both as bare casts and through GenericAssetRef (which is what
+// AssetManager::get and the loaders hand out). A sample is one pass over assets of 3 types, so about 1/3 of the casts succeed.
+
+#include "harness.hpp"
+
+#include "game/asset/asset.hpp"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace game {
+    namespace bench {
+        namespace {
+            struct TextureAsset final : Asset<TextureAsset> {
+                TextureAsset(const asset_id_t id, const std::string_view name) : Asset(id, name) {}
+            };
+
+            struct MeshAsset final : Asset<MeshAsset> {
+                MeshAsset(const asset_id_t id, const std::string_view name) : Asset(id, name) {}
+            };
+
+            struct SoundAsset final : Asset<SoundAsset> {
+                SoundAsset(const asset_id_t id, const std::string_view name) : Asset(id, name) {}
+            };
+
+            constexpr std::size_t ASSET_COUNT = 4096;
+
+            /**
+             * @brief Time a cast over every asset per sample
+             * @param cast Called with each asset index, returns if the cast succeeded
+             */
+            template <typename F>
+            void castPass(Harness &harness, const std::string &name, F &&cast) {
+                harness.run(name, ASSET_COUNT, [&] {
+                    std::size_t hits  = 0;
+                    const auto  start = std::chrono::steady_clock::now();
+                    for (std::size_t i = 0; i < ASSET_COUNT; i++) {
+                        hits += cast(i);
+                    }
+                    const auto elapsed = std::chrono::steady_clock::now() - start;
+                    doNotOptimize(hits);
+                    return elapsed;
+                });
+            }
+        } // namespace
+
+        void assetCastBenchmarks(Harness &harness) {
+            if (!harness.enabled("asset_cast/"))
+                return;
+
+            std::vector<std::unique_ptr<AssetBase>> owned;
+            std::vector<AssetBase *>                assets;
+            std::mt19937                            random(1234);
+            for (std::size_t i = 0; i < ASSET_COUNT; i++) {
+                switch (random() % 3) {
+                case 0:
+                    owned.push_back(std::make_unique<TextureAsset>(0, "texture"));
+                    break;
+                case 1:
+                    owned.push_back(std::make_unique<MeshAsset>(0, "mesh"));
+                    break;
+                default:
+                    owned.push_back(std::make_unique<SoundAsset>(0, "sound"));
+                    break;
+                }
+                assets.push_back(owned.back().get());
+            }
+
+            castPass(harness, "asset_cast/raw_dynamic_cast", [&](const std::size_t i) { return dynamic_cast<MeshAsset *>(assets[i]) != nullptr; });
+            castPass(harness, "asset_cast/raw_type_tag", [&](const std::size_t i) { return assetCast<MeshAsset>(assets[i]) != nullptr; });
+
+            // includes the reference count traffic, which both paths pay on a hit
+            const std::vector<GenericAssetRef> refs(assets.begin(), assets.end());
+            castPass(harness, "asset_cast/generic_ref_dynamic_cast", [&](const std::size_t i) {
+                auto *mesh = dynamic_cast<MeshAsset *>(assets[i]); // what GenericAssetRef::as used to do with the same asset
+                return static_cast<bool>(mesh != nullptr ? AssetRef<MeshAsset>(mesh) : AssetRef<MeshAsset>());
+            });
+            castPass(harness, "asset_cast/generic_ref_type_tag", [&](const std::size_t i) { return static_cast<bool>(refs[i].as<MeshAsset>()); });
+        }
+    } // namespace bench
+} // namespace game
@@ -0,0 +1,95 @@
+//
+// Created by andy on 7/8/2025.
+//
+
+// Per element costs of the MPMC queues in utils.hpp: an uncontended enqueue and dequeue (what the gc's removal queue mostly sees), and a fixed 2 producer, 2 consumer
+// handoff. The mpmc_queue suite has the stress check and the scaling sweep.
+
+#include "harness.hpp"
+
+#include "game/utils.hpp"
+
+#include <atomic>
+#include <latch>
+#include <thread>
+#include <vector>
+
+namespace game {
+    namespace bench {
+        namespace {
+            constexpr std::size_t CAPACITY     = 1024;
+            constexpr std::size_t BATCH        = 1 << 16;
+            constexpr unsigned    PRODUCERS    = 2;
+            constexpr unsigned    CONSUMERS    = 2;
+            constexpr uint64_t    PER_PRODUCER = 1 << 15;
+
+            template <typename Q, typename Push>
+            void handoff(Harness &harness, const std::string &name, Push &&push) {
+                harness.run(name, PER_PRODUCER * PRODUCERS, [&] {
+                    Q                     queue(CAPACITY);
+                    std::latch            ready(PRODUCERS + CONSUMERS + 1);
+                    std::latch            go(1);
+                    std::atomic<uint64_t> consumed = 0;
+
+                    std::vector<std::jthread> threads;
+                    for (unsigned p = 0; p < PRODUCERS; p++) {
+                        threads.emplace_back([&] {
+                            ready.count_down();
+                            go.wait();
+                            for (uint64_t i = 0; i < PER_PRODUCER; i++) {
+                                push(queue, i);
+                            }
+                        });
+                    }
+                    for (unsigned c = 0; c < CONSUMERS; c++) {
+                        threads.emplace_back([&] {
+                            ready.count_down();
+                            go.wait();
+                            uint64_t value;
+                            while (consumed.load(std::memory_order::relaxed) < PER_PRODUCER * PRODUCERS) {
+                                if (queue.try_dequeue(value))
+                                    consumed.fetch_add(1, std::memory_order::relaxed);
+                                else
+                                    std::this_thread::yield();
+                            }
+                        });
+                    }
+
+                    ready.arrive_and_wait();
+                    const auto start = std::chrono::steady_clock::now();
+                    go.count_down();
+                    threads.clear();
+                    return std::chrono::steady_clock::now() - start;
+                });
+            }
+        } // namespace
+
+        void concurrentQueueBenchmarks(Harness &harness) {
+            {
+                bounded_mpmc_queue<uint64_t> queue(CAPACITY);
+                harness.measure("concurrent_queue/bounded_uncontended", BATCH, [&, i = uint64_t{0}]() mutable {
+                    queue.try_enqueue(i++);
+                    uint64_t value;
+                    queue.try_dequeue(value);
+                    doNotOptimize(value);
+                });
+            }
+            {
+                unbounded_mpmc_queue<uint64_t> queue(CAPACITY);
+                harness.measure("concurrent_queue/unbounded_uncontended", BATCH, [&, i = uint64_t{0}]() mutable {
+                    queue.enqueue(i++);
+                    uint64_t value;
+                    queue.try_dequeue(value);
+                    doNotOptimize(value);
+                });
+            }
+
+            handoff<bounded_mpmc_queue<uint64_t>>(harness, "concurrent_queue/bounded_2p2c", [](auto &queue, uint64_t value) {
+                while (!queue.try_enqueue(std::move(value))) {
+                    std::this_thread::yield(); // full, wait for the consumers
+                }
+            });
+            handoff<unbounded_mpmc_queue<uint64_t>>(harness, "concurrent_queue/unbounded_2p2c", [](auto &queue, const uint64_t value) { queue.enqueue(value); });
+        }
+    } // namespace bench
+} // namespace game
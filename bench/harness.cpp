@@ -0,0 +1,169 @@
+//
+// Created by andy on 7/8/2025.
+//
+
+#include "harness.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace game {
+    namespace bench {
+        nlohmann::json Result::toJson() const {
+            return {
+                {"name", name},
+                {"samples", samples},
+                {"ops_per_sample", opsPerSample},
+                {"ns_per_op",
+                 {
+                     {"min", min},
+                     {"p50", p50},
+                     {"p90", p90},
+                     {"p99", p99},
+                     {"max", max},
+                     {"mean", mean},
+                 }},
+            };
+        }
+
+        Harness::Harness(Options options) : m_Options(std::move(options)) {
+            m_Options.samples = std::max<std::size_t>(m_Options.samples, 1);
+        }
+
+        Harness::~Harness() {
+            if (!m_Scratch.empty()) {
+                std::error_code error;
+                std::filesystem::remove_all(m_Scratch, error);
+            }
+        }
+
+        bool Harness::enabled(const std::string_view name) const {
+            return m_Options.filter.empty() || name.find(m_Options.filter) != std::string_view::npos;
+        }
+
+        void Harness::run(const std::string &name, const std::size_t opsPerSample, const std::function<std::chrono::nanoseconds()> &sample) {
+            if (!enabled(name))
+                return;
+            if (m_Options.list) {
+                std::printf("%s\n", name.c_str());
+                return;
+            }
+
+            for (std::size_t i = 0; i < m_Options.warmup; i++) {
+                sample();
+            }
+
+            std::vector<double> perOp(m_Options.samples);
+            for (auto &value : perOp) {
+                value = static_cast<double>(sample().count()) / static_cast<double>(std::max<std::size_t>(opsPerSample, 1));
+            }
+            std::ranges::sort(perOp);
+
+            // nearest rank, so p99 of 100 samples is the second slowest sample rather than something interpolated past it
+            const auto percentile = [&](const double p) {
+                const auto rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(perOp.size())));
+                return perOp[std::clamp<std::size_t>(rank, 1, perOp.size()) - 1];
+            };
+
+            const auto &result = m_Results.emplace_back(Result{
+                .name         = name,
+                .samples      = perOp.size(),
+                .opsPerSample = opsPerSample,
+                .min          = perOp.front(),
+                .p50          = percentile(0.5),
+                .p90          = percentile(0.9),
+                .p99          = percentile(0.99),
+                .max          = perOp.back(),
+                .mean         = std::accumulate(perOp.begin(), perOp.end(), 0.0) / static_cast<double>(perOp.size()),
+            });
+            std::printf(
+                "%-48s p50 %10.1f ns   p90 %10.1f ns   p99 %10.1f ns   max %10.1f ns\n", result.name.c_str(), result.p50, result.p90, result.p99, result.max
+            );
+            std::fflush(stdout);
+        }
+
+        void Harness::verify(const std::string &name, const std::function<bool()> &check) {
+            if (!enabled(name) || m_Options.list)
+                return;
+
+            const bool passed = check();
+            std::printf("%-48s %s\n", name.c_str(), passed ? "ok" : "FAILED");
+            std::fflush(stdout);
+            if (!passed)
+                throw std::runtime_error("Check '" + name + "' failed");
+        }
+
+        void Harness::skip(const std::string &name, const std::string_view reason) {
+            if (enabled(name) && !m_Options.list)
+                std::printf("%-48s skipped: %.*s\n", name.c_str(), static_cast<int>(reason.size()), reason.data());
+        }
+
+        const std::filesystem::path &Harness::scratch() {
+            if (m_Scratch.empty()) {
+                std::random_device random;
+                m_Scratch = std::filesystem::temp_directory_path() / ("tilegame_bench_" + std::to_string(random()));
+                std::filesystem::create_directories(m_Scratch);
+            }
+            return m_Scratch;
+        }
+
+        nlohmann::json Harness::toJson() const {
+            auto benchmarks = nlohmann::json::array();
+            for (const auto &result : m_Results) {
+                benchmarks.push_back(result.toJson());
+            }
+            return {
+                {"version", 1},
+                {"warmup", m_Options.warmup},
+                {"samples", m_Options.samples},
+#ifdef NDEBUG
+                {"optimized", true},
+#else
+                {"optimized", false},
+#endif
+                {"benchmarks", std::move(benchmarks)},
+            };
+        }
+
+        void Harness::save(const std::filesystem::path &path) const {
+            std::ofstream out(path, std::ios::trunc);
+            out << toJson().dump(4) << '\n';
+            if (!out)
+                throw std::runtime_error("Failed to write benchmark results '" + path.string() + "'");
+        }
+
+        std::size_t Harness::compare(const std::filesystem::path &baseline) const {
+            std::ifstream in(baseline);
+            if (!in)
+                throw std::runtime_error("Failed to open benchmark baseline '" + baseline.string() + "'");
+            const auto json = nlohmann::json::parse(in);
+
+            std::unordered_map<std::string, double> previous;
+            for (const auto &benchmark : json.at("benchmarks")) {
+                previous.emplace(benchmark.at("name").get<std::string>(), benchmark.at("ns_per_op").at("p50").get<double>());
+            }
+
+            std::printf("\ncompared with %s:\n", baseline.string().c_str());
+            std::size_t regressions = 0;
+            for (const auto &result : m_Results) {
+                const auto it = previous.find(result.name);
+                if (it == previous.end()) {
+                    std::printf("%-48s new\n", result.name.c_str());
+                    continue;
+                }
+
+                const auto change    = it->second > 0 ? result.p50 / it->second - 1.0 : 0.0;
+                const bool regressed = change > m_Options.threshold;
+                regressions += regressed;
+                std::printf("%-48s p50 %10.1f ns -> %10.1f ns  %+7.1f%%%s\n", result.name.c_str(), it->second, result.p50, change * 100.0, regressed ? "  REGRESSION" : "");
+            }
+            return regressions;
+        }
+    } // namespace bench
+} // namespace game
@@ -0,0 +1,148 @@
+//
+// Created by andy on 7/8/2025.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace game {
+    namespace bench {
+        struct Options {
+            std::size_t           warmup    = 10;  // samples run and thrown away before measuring
+            std::size_t           samples   = 100; // samples measured per benchmark
+            std::string           filter;          // only run benchmarks whose names contain this
+            std::filesystem::path json;            // write the results here (if set)
+            std::filesystem::path baseline;        // compare the results against an earlier json (if set)
+            double                threshold = 0.1; // a p50 this much slower than the baseline's is a regression
+            bool                  list      = false;
+        };
+
+        /**
+         * @brief The distribution of one benchmark's samples, in nanoseconds per operation.
+         */
+        struct Result {
+            std::string name;
+            std::size_t samples;
+            std::size_t opsPerSample;
+            double      min;
+            double      p50;
+            double      p90;
+            double      p99;
+            double      max;
+            double      mean;
+
+            [[nodiscard]] nlohmann::json toJson() const;
+        };
+
+        /**
+         * @brief Runs benchmarks and collects their results.
+         *
+         * A benchmark is a function timing one sample of some number of operations. Every benchmark gets the same number of warmup and measured samples, and is reported as
+         * percentiles of the time per operation over its samples, so one slow sample (a context switch, a page fault) shows up in p99 and max rather than moving p50.
+         */
+        class Harness {
+          public:
+            explicit Harness(Options options);
+            ~Harness();
+
+            Harness(const Harness &other)                = delete;
+            Harness(Harness &&other) noexcept            = delete;
+            Harness &operator=(const Harness &other)     = delete;
+            Harness &operator=(Harness &&other) noexcept = delete;
+
+            /**
+             * @return If a benchmark passes the filter (suites can skip expensive setup when none of theirs do)
+             */
+            [[nodiscard]] bool enabled(std::string_view name) const;
+
+            /**
+             * @brief Run a benchmark which times its own samples
+             * @param name The benchmark's name, conventionally "suite/benchmark"
+             * @param opsPerSample How many operations each sample does
+             * @param sample Does and times one sample, returning the time taken (setup and teardown around the timed part are not counted)
+             */
+            void run(const std::string &name, std::size_t opsPerSample, const std::function<std::chrono::nanoseconds()> &sample);
+
+            /**
+             * @brief Run a benchmark by timing batch calls of body per sample
+             */
+            template <typename F>
+            void measure(const std::string &name, const std::size_t batch, F &&body) {
+                run(name, batch, [&] {
+                    const auto start = std::chrono::steady_clock::now();
+                    for (std::size_t i = 0; i < batch; i++) {
+                        body();
+                    }
+                    return std::chrono::steady_clock::now() - start;
+                });
+            }
+
+            /**
+             * @brief Run a correctness check ahead of a suite's benchmarks. It's filtered like a benchmark and skipped when listing, and isn't part of the results.
+             * @param check Returns if the check passed
+             * @throws std::runtime_error if it didn't (the numbers of something broken aren't worth reporting)
+             */
+            void verify(const std::string &name, const std::function<bool()> &check);
+
+            /**
+             * @brief Note a benchmark that couldn't run here (no vulkan device, say). It's left out of the results.
+             */
+            void skip(const std::string &name, std::string_view reason);
+
+            /**
+             * @return A scratch directory for benchmarks to write files into (created on first use, removed with the harness)
+             */
+            const std::filesystem::path &scratch();
+
+            [[nodiscard]] inline const std::vector<Result> &results() const noexcept { return m_Results; }
+
+            [[nodiscard]] nlohmann::json toJson() const;
+
+            /**
+             * @brief Write toJson to a file
+             * @throws std::runtime_error if the file can't be written
+             */
+            void save(const std::filesystem::path &path) const;
+
+            /**
+             * @brief Print how each result's p50 moved against a baseline written by save
+             * @throws std::runtime_error if the baseline can't be read
+             * @return The number of benchmarks which regressed by more than the threshold
+             */
+            std::size_t compare(const std::filesystem::path &baseline) const;
+
+          private:
+            Options               m_Options;
+            std::vector<Result>   m_Results;
+            std::filesystem::path m_Scratch;
+        };
+
+        /**
+         * @brief Keep the compiler from optimizing away a value a benchmark computes
+         */
+        template <typename T>
+        inline void doNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+            asm volatile("" : : "r,m"(value) : "memory");
+#else
+            static const void *volatile sink;
+            sink = &value;
+#endif
+        }
+
+        void assetBenchmarks(Harness &harness);
+        void assetCastBenchmarks(Harness &harness);
+        void concurrentQueueBenchmarks(Harness &harness);
+        void manifestBenchmarks(Harness &harness);
+        void mpmcQueueBenchmarks(Harness &harness);
+        void singleTimeCommandsBenchmarks(Harness &harness);
+    } // namespace bench
+} // namespace game
@@ -0,0 +1,58 @@
+//
+// Created by andy on 7/8/2025.
+//
+
+// Parsing a bundle manifest: as text, through asset_util::parseMetadata (what loaders call), and as a hit in a saved metadata cache.
+
+#include "harness.hpp"
+
+#include "game/asset/asset_metadata_cache.hpp"
+
+#include <string>
+
+namespace game {
+    namespace bench {
+        namespace {
+            constexpr std::size_t ENTRY_COUNT = 256;
+            constexpr std::size_t BATCH       = 16;
+
+            /**
+             * @return A bundle manifest shaped like the ones in assets/, with ENTRY_COUNT entries split over a few loaders (every fourth one with dependencies)
+             */
+            std::string generateManifest() {
+                static constexpr const char *LOADERS[] = {"texture", "shader_object", "linked_shader", "pipeline_layout"};
+
+                nlohmann::json assets = nlohmann::json::object();
+                for (std::size_t i = 0; i < ENTRY_COUNT; i++) {
+                    const auto *loader = LOADERS[i % std::size(LOADERS)];
+                    auto        path   = std::string(loader) + "s/generated_" + std::to_string(i) + ".json";
+                    if (i % 4 == 3)
+                        assets[loader].push_back({{"path", std::move(path)}, {"depends", {"render/sample_pipeline_layout.json", "shaders/generated_" + std::to_string(i - 1) + ".json"}}});
+                    else
+                        assets[loader].push_back(std::move(path));
+                }
+                return nlohmann::json{{"type", "asset_bundle"}, {"name", "generated_bundle"}, {"assets", std::move(assets)}}.dump(4);
+            }
+        } // namespace
+
+        void manifestBenchmarks(Harness &harness) {
+            if (!harness.enabled("manifest/"))
+                return;
+
+            const auto manifest = generateManifest();
+            const auto text     = std::span(reinterpret_cast<const unsigned char *>(manifest.data()), manifest.size());
+
+            harness.measure("manifest/parse_text", BATCH, [&] { doNotOptimize(nlohmann::json::parse(manifest)); });
+            harness.measure("manifest/parse_metadata", BATCH, [&] { doNotOptimize(asset_util::parseMetadata(text)); });
+
+            const auto path = harness.scratch() / "bench_metadata.cache";
+            {
+                AssetMetadataCache cache(path);
+                cache.put(text, nlohmann::json::parse(manifest));
+                cache.save();
+            }
+            const AssetMetadataCache cache(path);
+            harness.measure("manifest/metadata_cache_hit", BATCH, [&] { doNotOptimize(cache.find(text)); });
+        }
+    } // namespace bench
+} // namespace game
@@ -0,0 +1,186 @@
+//
+// Created by andy on 6/30/2025.
+//
+
+// Stress test and scaling sweep for the MPMC queues in utils.hpp (with a mutex + deque as the baseline).
+//
+// The stress check has every producer push a tagged, increasing sequence and checks that every element comes out exactly once and that each consumer sees each producer's
+// elements in order. It runs before the measurements and fails the whole run if it fails. The sweep times PER_PRODUCER elements per producer through each queue, for
+// producer/consumer counts up to the machine's thread count, and reports the time per element.
+
+#include "harness.hpp"
+
+#include "game/utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace game {
+    namespace bench {
+        namespace {
+            constexpr std::size_t BOUNDED_CAPACITY = 1024;
+            constexpr uint64_t    STRESS_ELEMENTS  = 200000; // per producer
+            constexpr uint64_t    PER_PRODUCER     = 1 << 14;
+
+            class mutex_deque_queue {
+                std::mutex           m_Mutex;
+                std::deque<uint64_t> m_Queue;
+
+              public:
+                bool try_enqueue(uint64_t &&value) {
+                    std::lock_guard lock(m_Mutex);
+                    m_Queue.push_back(value);
+                    return true;
+                }
+
+                bool try_dequeue(uint64_t &out) {
+                    std::lock_guard lock(m_Mutex);
+                    if (m_Queue.empty())
+                        return false;
+                    out = m_Queue.front();
+                    m_Queue.pop_front();
+                    return true;
+                }
+            };
+
+            class bounded_queue : public bounded_mpmc_queue<uint64_t> {
+              public:
+                bounded_queue() : bounded_mpmc_queue(BOUNDED_CAPACITY) {}
+            };
+
+            class unbounded_queue : public unbounded_mpmc_queue<uint64_t> {
+              public:
+                unbounded_queue() : unbounded_mpmc_queue(BOUNDED_CAPACITY) {}
+
+                bool try_enqueue(uint64_t &&value) {
+                    enqueue(value);
+                    return true;
+                }
+            };
+
+            constexpr uint64_t encode(const unsigned producer, const uint64_t sequence) noexcept { return static_cast<uint64_t>(producer) << 40 | sequence; }
+
+            struct RunResult {
+                std::chrono::nanoseconds elapsed;
+                bool                     valid;
+            };
+
+            /**
+             * @brief Push perProducer elements from each producer through the queue and pop them all with the consumers
+             * @param check Whether to validate what comes out (costs a little per element, so it's off for the timed runs)
+             */
+            template <typename Q>
+            RunResult pump(const unsigned producers, const unsigned consumers, const uint64_t perProducer, const bool check) {
+                Q                     queue;
+                std::atomic<unsigned> ready    = 0;
+                std::atomic<bool>     go       = false;
+                std::atomic<uint64_t> consumed = 0;
+                std::atomic<bool>     valid    = true;
+                const uint64_t        total    = perProducer * producers;
+
+                std::vector<std::vector<uint32_t>> seen(consumers, std::vector<uint32_t>(check ? total : 0));
+
+                std::vector<std::jthread> threads;
+                for (unsigned p = 0; p < producers; p++) {
+                    threads.emplace_back([&, p] {
+                        ready++;
+                        while (!go.load(std::memory_order::acquire)) {
+                            std::this_thread::yield();
+                        }
+                        for (uint64_t i = 0; i < perProducer; i++) {
+                            while (!queue.try_enqueue(encode(p, i))) {
+                                std::this_thread::yield(); // full, wait for the consumers
+                            }
+                        }
+                    });
+                }
+                for (unsigned c = 0; c < consumers; c++) {
+                    threads.emplace_back([&, c] {
+                        std::vector<int64_t> last(producers, -1);
+                        ready++;
+                        while (!go.load(std::memory_order::acquire)) {
+                            std::this_thread::yield();
+                        }
+                        uint64_t value;
+                        while (consumed.load(std::memory_order::relaxed) < total) {
+                            if (!queue.try_dequeue(value)) {
+                                std::this_thread::yield();
+                                continue;
+                            }
+                            consumed.fetch_add(1, std::memory_order::relaxed);
+                            if (!check)
+                                continue;
+
+                            const auto producer = static_cast<unsigned>(value >> 40);
+                            const auto sequence = static_cast<int64_t>(value & ((uint64_t{1} << 40) - 1));
+                            if (producer >= producers || sequence >= static_cast<int64_t>(perProducer) || sequence <= last[producer]) {
+                                valid = false; // garbage, or out of order for this producer
+                                continue;
+                            }
+                            last[producer] = sequence;
+                            seen[c][producer * perProducer + sequence]++;
+                        }
+                    });
+                }
+
+                while (ready.load() < producers + consumers) {
+                    std::this_thread::yield();
+                }
+                const auto start = std::chrono::steady_clock::now();
+                go.store(true, std::memory_order::release);
+                threads.clear();
+                const auto elapsed = std::chrono::steady_clock::now() - start;
+
+                if (check) {
+                    for (uint64_t i = 0; i < total; i++) {
+                        uint32_t count = 0;
+                        for (const auto &s : seen) {
+                            count += s[i];
+                        }
+                        if (count != 1)
+                            valid = false; // lost or duplicated
+                    }
+                }
+                return {elapsed, valid.load()};
+            }
+
+            template <typename Q>
+            bool stress(const std::vector<std::pair<unsigned, unsigned>> &configs) {
+                return std::ranges::all_of(configs, [](const auto &config) { return pump<Q>(config.first, config.second, STRESS_ELEMENTS, true).valid; });
+            }
+
+            template <typename Q>
+            void sweep(Harness &harness, const std::string &name, const std::vector<std::pair<unsigned, unsigned>> &configs) {
+                for (const auto &[producers, consumers] : configs) {
+                    harness.run("mpmc_queue/" + name + "_" + std::to_string(producers) + "p" + std::to_string(consumers) + "c", PER_PRODUCER * producers, [&] {
+                        return pump<Q>(producers, consumers, PER_PRODUCER, false).elapsed;
+                    });
+                }
+            }
+        } // namespace
+
+        void mpmcQueueBenchmarks(Harness &harness) {
+            // the stress configurations oversubscribe small machines on purpose, preemption in the middle of an operation is where the races are
+            const std::vector<std::pair<unsigned, unsigned>> stressConfigs = {{1, 1}, {4, 1}, {1, 4}, {4, 4}, {8, 8}};
+            harness.verify("mpmc_queue/stress_bounded", [&] { return stress<bounded_queue>(stressConfigs); });
+            harness.verify("mpmc_queue/stress_unbounded", [&] { return stress<unbounded_queue>(stressConfigs); });
+
+            const unsigned                             threads = std::max(2U, std::thread::hardware_concurrency());
+            std::vector<std::pair<unsigned, unsigned>> configs = {{1, 1}};
+            for (unsigned n = 2; n <= threads / 2; n *= 2) {
+                configs.emplace_back(n, 1);
+                configs.emplace_back(1, n);
+                configs.emplace_back(n, n);
+            }
+
+            sweep<bounded_queue>(harness, "bounded", configs);
+            sweep<unbounded_queue>(harness, "unbounded", configs);
+            sweep<mutex_deque_queue>(harness, "mutex_deque", configs);
+        }
+    } // namespace bench
+} // namespace game
@@ -0,0 +1,55 @@
+//
+// Created by andy on 7/8/2025.
+//
+
+// Submitting empty one-time command buffers and recycling them with pollInUse. Needs a vulkan device (a software one will do), and is skipped without one.
+
+#include "harness.hpp"
+
+#include "game/render/single_time_commands.hpp"
+
+namespace game {
+    namespace bench {
+        namespace {
+            constexpr std::size_t RUNS = 64; // command buffers submitted per sample
+        } // namespace
+
+        void singleTimeCommandsBenchmarks(Harness &harness) {
+            if (!harness.enabled("single_time_commands/"))
+                return;
+
+            try {
+                const auto         device = std::make_shared<RenderDevice>(true); // headless, so this runs without a display
+                SingleTimeCommands stc(device, device->mainFamily(), device->mainQueue());
+
+                const auto submit = [&] {
+                    for (std::size_t i = 0; i < RUNS; i++) {
+                        stc.runCommands([](const vk::raii::CommandBuffer &) {}, std::nullopt, std::nullopt);
+                    }
+                };
+
+                harness.run("single_time_commands/run_empty", RUNS, [&] {
+                    const auto start = std::chrono::steady_clock::now();
+                    submit();
+                    const auto end = std::chrono::steady_clock::now();
+                    device->device().waitIdle();
+                    stc.pollInUse();
+                    return end - start;
+                });
+
+                // every buffer's fence has signalled, so this is the full cost of handing them all back
+                harness.run("single_time_commands/poll_in_use", RUNS, [&] {
+                    submit();
+                    device->device().waitIdle();
+                    const auto start = std::chrono::steady_clock::now();
+                    stc.pollInUse();
+                    return std::chrono::steady_clock::now() - start;
+                });
+
+                device->device().waitIdle();
+            } catch (const std::exception &e) {
+                harness.skip("single_time_commands/", e.what());
+            }
+        }
+    } // namespace bench
+} // namespace game
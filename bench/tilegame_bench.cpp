@@ -0,0 +1,85 @@
+//
+// Created by andy on 7/8/2025.
+//
+
+// The benchmark suite for the engine's hot paths. Run it from a release build, save the results with --json and compare a later build against them with --baseline:
+//
+//   tilegame_bench --json before.json
+//   tilegame_bench --baseline before.json --threshold 0.05
+//
+// which exits with 2 if any benchmark's p50 got slower by more than the threshold. --filter runs only the benchmarks whose names contain a string, and --list prints the names.
+
+#include "harness.hpp"
+#include "spdlog/spdlog.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string_view>
+
+namespace {
+    void usage() {
+        std::printf(
+            "usage: tilegame_bench [--filter text] [--samples n] [--warmup n] [--json out.json] [--baseline in.json] [--threshold fraction] [--list]\n"
+        );
+    }
+} // namespace
+
+int main(const int argc, char **argv) {
+    using namespace game::bench;
+
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        const auto             value = [&]() -> const char * {
+            if (i + 1 >= argc) {
+                usage();
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--filter")
+            options.filter = value();
+        else if (arg == "--samples")
+            options.samples = std::strtoull(value(), nullptr, 10);
+        else if (arg == "--warmup")
+            options.warmup = std::strtoull(value(), nullptr, 10);
+        else if (arg == "--json")
+            options.json = std::filesystem::absolute(value());
+        else if (arg == "--baseline")
+            options.baseline = std::filesystem::absolute(value());
+        else if (arg == "--threshold")
+            options.threshold = std::strtod(value(), nullptr);
+        else if (arg == "--list")
+            options.list = true;
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    // the gc logs every asset it deletes, which would drown out the results (and time stdout instead of the gc)
+    spdlog::set_level(spdlog::level::warn);
+
+    const auto json     = options.json;
+    const auto baseline = options.baseline;
+    try {
+        Harness harness(std::move(options));
+        assetBenchmarks(harness);
+        assetCastBenchmarks(harness);
+        concurrentQueueBenchmarks(harness);
+        mpmcQueueBenchmarks(harness);
+        manifestBenchmarks(harness);
+        singleTimeCommandsBenchmarks(harness);
+
+        if (!json.empty())
+            harness.save(json);
+        if (!baseline.empty() && harness.compare(baseline) > 0)
+            return 2;
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -4,5 +4,48 @@
 
 #include "asset.hpp"
 
+#include "game/asset/asset_manager.hpp"
+
+#include <stdexcept>
+
 namespace game {
-} // game
\ No newline at end of file
+    DeferredAssetRefs::DeferredAssetRefs() {
+        if (s_Current != nullptr)
+            throw std::logic_error("This thread already defers asset reference releases");
+        s_Current = this;
+    }
+
+    DeferredAssetRefs::~DeferredAssetRefs() {
+        flush();
+        s_Current = nullptr;
+    }
+
+    void DeferredAssetRefs::flush() noexcept {
+        for (auto &slot : m_Slots) {
+            apply(slot);
+        }
+    }
+
+    void DeferredAssetRefs::apply(Slot &slot) noexcept {
+        if (slot.pending == 0)
+            return;
+        slot.asset->releaseRefs(static_cast<asset_refcount_t>(slot.pending));
+        slot.pending = 0;
+    }
+
+    bool AssetBase::reviveRef(const AssetBase *asset, AssetManager *manager, const asset_id_t id) noexcept {
+        if (manager == nullptr)
+            return false;
+        // the gc erases an asset from the registry before removing it, and only while it has no references, so finding it under the shard lock means it is still alive
+        return manager->m_Registry.visit(id, [asset](AssetBase *registered) {
+            if (registered != asset)
+                return false;
+            registered->incRef();
+            return true;
+        });
+    }
+
+    void AssetBase::notifyUnused(AssetBase *asset, AssetManager *manager) noexcept {
+        manager->queueCandidate(asset);
+    }
+} // game
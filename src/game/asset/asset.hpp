@@ -4,8 +4,15 @@
 
 #pragma once
 
+#include "game/asset/asset_epoch.hpp"
+#include "game/asset/asset_id.hpp"
+#include "game/asset/asset_name.hpp"
+#include "game/asset/asset_slot_map.hpp"
+
+#include <array>
 #include <atomic>
 #include <concepts>
+#include <cstdint>
 #include <iostream>
 #include <string>
 
@@ -14,30 +21,8 @@
 #endif
 
 namespace game {
-#ifdef ASSETS_64BIT_ID
-    /**
-     * @brief The type of an asset id
-     */
-    using asset_id_t = uint64_t;
-
-    /**
-     * @brief The type of the asset counter
-     */
-    using asset_counter_t = std::atomic_uint64_t;
-    constexpr asset_id_t STATIC_ID_DOMAIN = 0xFFFF << 48;
-#else
-    /**
-     * @brief The type of an asset id
-     */
-    using asset_id_t = uint32_t;
-
-    /**
-     * @brief The type of the asset counter
-     */
-    using asset_counter_t = std::atomic_uint32_t;
-
-    constexpr asset_id_t STATIC_ID_DOMAIN = 0xFF << 24;
-#endif
+    class AssetManager;
+    class AssetBase;
 
     /**
      * \def ASSETS_MAX_REFERENCES
@@ -116,6 +101,139 @@ namespace game {
     template <typename T>
     class AssetWeak;
 
+    /**
+     * @brief Identifies the concrete type of an asset (the T of its Asset<T> base), so casts from AssetBase can be checked without RTTI.
+     */
+    using asset_type_tag_t = const void *;
+
+    namespace asset_detail {
+        template <typename T>
+        struct TypeTag {
+            static constexpr char value = 0; // only the address matters, and every type gets its own
+        };
+    } // namespace asset_detail
+
+    /**
+     * @return The type tag of an asset type. This is a constant expression, so checks against it fold down to a single pointer compare.
+     */
+    template <typename T>
+    constexpr asset_type_tag_t assetTypeTag() noexcept {
+        return &asset_detail::TypeTag<T>::value;
+    }
+
+    /**
+     * @brief Defers dropping asset references on the current thread, which takes the atomic off the hot path of copying and destroying references (deferred reference
+     * counting).
+     *
+     * While one is installed on a thread, dropping a reference to a managed asset doesn't touch the asset's counter, the release is added to a per-thread table instead.
+     * Copying a reference to an asset with a pending release cancels one out, so a loop copying and dropping references to the same assets makes no atomic operations after
+     * its first iteration. Copies with nothing to cancel still increment the counter atomically.
+     *
+     * Only releases are deferred, so an asset's counter is never below its real number of references, and the gc can't see a referenced asset as unused whatever thread
+     * references end up being dropped on. Unreferenced assets just aren't handed to the gc until the pending releases are flushed: flush at a safe point every frame, before
+     * starting the gc cycle, and before the asset manager is destroyed. refcount() includes pending releases until then.
+     */
+    class DeferredAssetRefs {
+      public:
+        static constexpr std::size_t SLOTS = 256; // direct mapped by address, an asset landing in a slot another asset has pending releases in flushes the other one
+
+        /**
+         * @brief Installs the table on the current thread
+         * @throws std::logic_error if the thread already has one
+         */
+        DeferredAssetRefs();
+
+        /**
+         * @brief Flushes and uninstalls the table
+         */
+        ~DeferredAssetRefs();
+
+        DeferredAssetRefs(const DeferredAssetRefs &other)                = delete;
+        DeferredAssetRefs(DeferredAssetRefs &&other) noexcept            = delete;
+        DeferredAssetRefs &operator=(const DeferredAssetRefs &other)     = delete;
+        DeferredAssetRefs &operator=(DeferredAssetRefs &&other) noexcept = delete;
+
+        /**
+         * @brief Apply every pending release, handing assets which lost their last reference to their manager's gc
+         */
+        void flush() noexcept;
+
+        /**
+         * @return The table installed on the current thread, or nullptr if the thread drops references eagerly
+         */
+        [[nodiscard]] static inline DeferredAssetRefs *current() noexcept { return s_Current; }
+
+        /**
+         * @brief Drops references eagerly on the current thread for as long as it exists. The gc's deletion step uses this, so whatever deleting an asset releases is
+         * collected in the same step.
+         */
+        class Suspend {
+          public:
+            inline Suspend() noexcept : m_Suspended(s_Current) { s_Current = nullptr; }
+
+            inline ~Suspend() { s_Current = m_Suspended; }
+
+            Suspend(const Suspend &other)                = delete;
+            Suspend(Suspend &&other) noexcept            = delete;
+            Suspend &operator=(const Suspend &other)     = delete;
+            Suspend &operator=(Suspend &&other) noexcept = delete;
+
+          private:
+            DeferredAssetRefs *m_Suspended;
+        };
+
+      private:
+        friend class AssetBase;
+
+        struct Slot {
+            AssetBase *asset   = nullptr;
+            uint32_t   pending = 0; // releases not applied to the asset's counter yet (never more than its references, so this can't overflow)
+        };
+
+        static inline std::size_t slotIndex(const AssetBase *asset) noexcept {
+            const auto address = reinterpret_cast<std::uintptr_t>(asset);
+            return ((address >> 4) ^ (address >> 12)) & (SLOTS - 1);
+        }
+
+        /**
+         * @return If there was a pending release of the asset to cancel
+         */
+        inline bool cancelRelease(const AssetBase *asset) noexcept {
+            auto &slot = m_Slots[slotIndex(asset)];
+            if (slot.asset != asset || slot.pending == 0)
+                return false;
+            slot.pending--;
+            return true;
+        }
+
+        inline void deferRelease(AssetBase *asset) noexcept {
+            auto &slot = m_Slots[slotIndex(asset)];
+            if (slot.asset != asset) {
+                apply(slot); // the slot's asset can't be gone while it has releases pending, they are still counted as references
+                slot.asset = asset;
+            }
+            slot.pending++;
+        }
+
+        static void apply(Slot &slot) noexcept;
+
+        std::array<Slot, SLOTS> m_Slots{};
+
+        static thread_local inline DeferredAssetRefs *s_Current = nullptr;
+    };
+
+    static_assert((DeferredAssetRefs::SLOTS & (DeferredAssetRefs::SLOTS - 1)) == 0, "DeferredAssetRefs::SLOTS must be a power of two");
+
+    /**
+     * @brief How much memory an asset holds on to
+     */
+    struct AssetFootprint {
+        std::size_t cpuBytes = 0;
+        std::size_t gpuBytes = 0;
+
+        [[nodiscard]] inline std::size_t total() const noexcept { return cpuBytes + gpuBytes; }
+    };
+
     /**
      * @brief Base class for assets
      *
@@ -127,25 +245,68 @@ namespace game {
          * @brief Base constructor for assets
          * @param id The asset's id
          * @param name The name of the asset
+         * @param typeTag The tag of the asset's concrete type (Asset<T> passes assetTypeTag<T>())
          */
-        inline explicit AssetBase(const asset_id_t id, const std::string &name) : m_Id(id), m_Name(name), m_RefCount(0) {}
+        inline explicit AssetBase(const asset_id_t id, const std::string_view name, const asset_type_tag_t typeTag)
+            : m_Id(id), m_RefCount(0), m_Name(name), m_TypeTag(typeTag) {}
 
         inline virtual ~AssetBase() = default;
 
         /**
          * @brief Get the name of the asset
-         * @return The asset's name
+         * @return The asset's name (the name declared by its metadata, or the path it was loaded from). Interned, so the view is valid for the life of the program.
          */
-        [[nodiscard]] inline std::string name() const noexcept { return m_Name; }
+        [[nodiscard]] inline std::string_view name() const noexcept { return m_Name.view(); }
+
+        /**
+         * @brief Get the path the asset was loaded from
+         * @return The source path (relative to the assets directory), or an empty view if the asset wasn't loaded from a file
+         */
+        [[nodiscard]] inline std::string_view sourcePath() const noexcept { return m_SourcePath.view(); }
+
+        /**
+         * @return The tag of the asset's concrete type
+         */
+        [[nodiscard]] inline asset_type_tag_t typeTag() const noexcept { return m_TypeTag; }
 
         [[nodiscard]] inline asset_refcount_t refcount() const noexcept { return m_RefCount.load(std::memory_order::relaxed); }
 
         inline void setKeepAlive() { m_KeepAlive.test_and_set(std::memory_order::seq_cst); }
 
-        inline void unsetKeepAlive() { m_KeepAlive.clear(std::memory_order::seq_cst); }
+        inline void unsetKeepAlive() {
+            const auto manager = m_Manager;
+            m_KeepAlive.clear(std::memory_order::seq_cst);
+            if (manager != nullptr)
+                notifyUnused(this, manager); // the gc checks if it is actually unused
+        }
 
         [[nodiscard]] inline bool isKeepAlive() const noexcept { return m_KeepAlive.test(std::memory_order::seq_cst); }
 
+        /**
+         * @return If nothing is keeping the asset alive (no references and no keep alive), which makes it eligible for removal
+         */
+        [[nodiscard]] inline bool isUnused() const noexcept { return !isKeepAlive() && m_RefCount.load(std::memory_order::seq_cst) == 0; }
+
+        /**
+         * @brief Swap this asset's contents with another asset of the same type. Hot reload uses this to move a freshly loaded copy into the live asset, so everything
+         * referencing the live asset sees the new contents without looking it up again.
+         *
+         * Only the contents are swapped, the id, names, reference count and registration stay with each object. Nothing else may be using either asset's contents while this
+         * runs.
+         *
+         * @param other The asset to swap with (the same concrete type as this for the swap to succeed)
+         * @return If the contents were swapped. Asset types that don't support it keep the default, which swaps nothing and returns false.
+         */
+        virtual bool swapContents([[maybe_unused]] AssetBase &other) { return false; }
+
+        /**
+         * @brief Get how much memory the asset holds on to, which is what unreferenced assets are charged against the manager's residency budget. Doesn't include assets it
+         * references, those are charged for themselves.
+         *
+         * The default only counts the base object, asset types that own more than that should override this.
+         */
+        [[nodiscard]] virtual AssetFootprint footprint() const noexcept { return {sizeof(AssetBase), 0}; }
+
       protected:
         /**
          * @brief Get the raw id of the asset
@@ -164,21 +325,81 @@ namespace game {
         } // NOLINT(*-assert-side-effect)
 
         /**
-         * @brief Decrement the reference counter for this asset
+         * @brief Increment the reference counter unless it is zero. Only an asset with no references can be removed by the gc, so this can't revive one being removed.
+         * @return If the counter was incremented
+         */
+        inline bool tryIncRef() noexcept {
+            auto count = m_RefCount.load(std::memory_order::relaxed);
+            while (count != 0) {
+                if (m_RefCount.compare_exchange_weak(count, count + 1, std::memory_order::relaxed))
+                    return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief Take a reference to an asset with no references through its manager's registry, which synchronizes with the gc removing it (it may be kept resident, see
+         * AssetManager::setResidencyBudget). Static, since the asset may be removed by the time the registry is locked.
+         * @return If the asset was still registered and a reference was taken
+         */
+        static bool reviveRef(const AssetBase *asset, AssetManager *manager, asset_id_t id) noexcept;
+
+        /**
+         * @return The manager the asset is registered with, or nullptr
+         */
+        [[nodiscard]] inline AssetManager *manager() const noexcept { return m_Manager; }
+
+        /**
+         * @brief Increment the reference counter for a copy of an existing reference, which cancels a pending release instead if the thread defers them (see
+         * DeferredAssetRefs)
+         */
+        inline void copyRef() noexcept {
+            if (auto *deferred = DeferredAssetRefs::current(); deferred != nullptr && deferred->cancelRelease(this))
+                return;
+            incRef();
+        }
+
+        /**
+         * @brief Decrement the reference counter for this asset. Dropping the last reference to a registered asset hands it to the manager's gc. Deferred if the thread defers
+         * releases and the asset is registered (see DeferredAssetRefs).
          */
         inline void decRef() noexcept {
-            const auto i = m_RefCount.fetch_sub(1, std::memory_order::relaxed);
+            if (auto *deferred = DeferredAssetRefs::current(); deferred != nullptr && m_Manager != nullptr) {
+                deferred->deferRelease(this);
+                return;
+            }
+            releaseRefs(1);
+        }
+
+        /**
+         * @brief Subtract from the reference counter for this asset, handing it to the manager's gc if that dropped the last reference
+         */
+        inline void releaseRefs(const asset_refcount_t count) noexcept {
+            const auto manager = m_Manager; // read first, once the count hits zero the gc is free to delete this asset out from under us
+            const auto i       = m_RefCount.fetch_sub(count, std::memory_order::acq_rel);
             asset_rc_assert_dec(i);
+            if (i == count && manager != nullptr)
+                notifyUnused(this, manager);
         } // NOLINT(*-assert-side-effect)
 
         friend class AssetManager;
+        friend class AssetRegistry;
         friend class GenericAssetRef;
+        friend class DeferredAssetRefs;
 
       private:
         asset_id_t       m_Id;
         asset_rc_t       m_RefCount;
-        std::string      m_Name;
+        AssetName        m_Name;
+        AssetName        m_SourcePath; // set by the manager when it loads the asset, indexed alongside the name
+        asset_type_tag_t m_TypeTag;
         std::atomic_flag m_KeepAlive;
+        AssetManager    *m_Manager = nullptr; // set once the asset is registered
+
+        /**
+         * @brief Hand an asset to the manager's gc as a candidate for removal. Static (and must not dereference the asset), since the asset may already be gone.
+         */
+        static void notifyUnused(AssetBase *asset, AssetManager *manager) noexcept;
     };
 
     /**
@@ -216,7 +437,7 @@ namespace game {
          * @param id The id of this asset
          * @param name The name of this asset
          */
-        inline explicit Asset(const asset_id_t id, const std::string &name) : AssetBase(id, name) {}
+        inline explicit Asset(const asset_id_t id, const std::string_view name) : AssetBase(id, name, assetTypeTag<T>()) {}
 
         /**
          * @brief Get a type-safe handle to this asset
@@ -232,9 +453,27 @@ namespace game {
     template <typename T>
     concept asset_type = std::derived_from<T, Asset<T>>;
 
+    /**
+     * @brief Checked downcast from AssetBase. Compares the asset's type tag instead of using dynamic_cast.
+     * @return The asset as a T, or nullptr if the asset is null or isn't a T
+     */
+    template <asset_type T>
+    inline T *assetCast(AssetBase *asset) noexcept {
+        return asset != nullptr && asset->typeTag() == assetTypeTag<T>() ? static_cast<T *>(asset) : nullptr;
+    }
+
     template <asset_type T>
     struct AssetHandle<T> {
         asset_id_t id;
+
+        /**
+         * @brief Resolve the handle (a slot lookup and a generation compare, see AssetSlotMap). Takes no lock and no reference, so resolve inside an AssetReadGuard (or while
+         * holding a reference) to use the asset, the result stays valid until the guard ends.
+         * @return The asset, or nullptr if it has been removed since the handle was made
+         */
+        [[nodiscard]] inline T *get() const noexcept { return assetCast<T>(AssetSlotMap::resolve(id)); } // checked, a very stale id can resolve again (see AssetSlotMap)
+
+        [[nodiscard]] inline bool expired() const noexcept { return AssetSlotMap::resolve(id) == nullptr; }
     };
 
     template <asset_type T>
@@ -252,21 +491,28 @@ namespace game {
 
         /**
          * @brief Constructor accepting a non-const pointer to the asset we are constructing a reference to.
-         * @param asset  The asset to make a reference to.
+         * @param asset  The asset to make a reference to (can be nullptr, which makes an empty reference).
          */
-        AssetRef(T *const asset) : m_Asset(asset) { m_Asset->incRef(); }
+        AssetRef(T *const asset) : m_Asset(asset) {
+            if (m_Asset != nullptr)
+                m_Asset->incRef();
+        }
 
         /**
          * @brief Copy constructor. Will change refcount.
          * @param o
          */
-        AssetRef(const AssetRef &o) : m_Asset(o.m_Asset) { m_Asset->incRef(); }
+        AssetRef(const AssetRef &o) : m_Asset(o.m_Asset) {
+            if (m_Asset != nullptr)
+                m_Asset->copyRef();
+        }
 
         AssetRef(AssetRef &&other) noexcept : m_Asset(other.m_Asset) { other.m_Asset = nullptr; }
 
         AssetRef &operator=(AssetRef &&other) noexcept {
             if (this == &other)
                 return *this;
+            reset();
             m_Asset       = other.m_Asset;
             other.m_Asset = nullptr;
             return *this;
@@ -278,12 +524,11 @@ namespace game {
          * @return
          */
         AssetRef &operator=(const AssetRef &rhs) noexcept {
-            if (m_Asset && m_Asset != rhs.m_Asset) {
-                m_Asset->decRef();
-            }
-
-            m_Asset = rhs.m_Asset;
-            m_Asset->incRef();
+            auto *asset = rhs.m_Asset; // rhs might be this
+            if (asset != nullptr)
+                asset->copyRef(); // before the release, in case this is the last other reference to the same asset
+            reset();
+            m_Asset = asset;
             return *this;
         }
 
@@ -352,6 +597,15 @@ namespace game {
 
         // ReSharper restore CppNonExplicitConvertingConstructor
       private:
+        friend class AssetWeak<T>;
+
+        struct adopt_t {};
+
+        /**
+         * @brief Take over a reference already counted for the asset
+         */
+        AssetRef(T *const asset, adopt_t) noexcept : m_Asset(asset) {}
+
         T *m_Asset;
     };
 
@@ -359,47 +613,74 @@ namespace game {
     class AssetWeak<T> {
       public:
         // ReSharper disable CppNonExplicitConvertingConstructor
+        AssetWeak() : m_Id(0), m_Asset(nullptr) {}
+
         /**
          * @brief Constructor accepting a non-const lvalue reference to an asset
          * @param asset The asset
          */
-        AssetWeak(T &asset) : m_Asset(&asset) {}
+        AssetWeak(T &asset) : m_Id(asset.handle().id), m_Asset(&asset) {}
 
         /**
          * @brief Constructor accepting a strong reference to an asset
          * @param asset The asset reference
          */
-        AssetWeak(const AssetRef<T> &asset) : m_Asset(asset.m_Asset) {}
+        AssetWeak(const AssetRef<T> &asset) : AssetWeak(asset.m_Asset) {}
 
         /**
          * @brief Constructor accepting a non-const pointer to an asset
          * @param asset The asset
          */
-        AssetWeak(T *const asset) : m_Asset(asset) {}
+        AssetWeak(T *const asset) : m_Id(asset != nullptr ? asset->handle().id : 0), m_Asset(asset) {}
 
         // this class can use default copy and move constructors since it doesn't do any reference counting
 
         /**
-         * @brief Convert this weak reference to a strong reference
-         * @return A strong reference to the asset
-         * This does no checks to see if our weak reference is valid, so you can still get an access violation using the returned reference. This is only important since using the
-         * asset from a reference should require incrementing the refcount.
+         * @brief Check if the asset has been removed. This is the id's generation compared against its slot, so the asset itself is never touched.
          *
-         * @note Try not to call this frequently, as it does increment an atomic counter. Instead store the reference while you need it and remove when you don't anymore. If you
-         * need freeform access and aren't worried about lifetime, obtain and use a raw pointer.
+         * Assets with the zero id aren't managed, so weak references to them can't tell and never report expired.
          */
-        [[nodiscard]] AssetRef<T> lock() const { return AssetRef<T>(m_Asset); }
+        [[nodiscard]] bool expired() const noexcept {
+            if (m_Id == 0)
+                return m_Asset == nullptr;
+            return AssetSlotMap::resolve(m_Id) != m_Asset;
+        }
 
-        [[nodiscard]] AssetHandle<T> handle() const noexcept { return m_Asset->handle(); }
+        /**
+         * @brief Get the asset without taking a reference. Takes no lock either, so this is the cheap way to read an asset from any thread, inside an AssetReadGuard.
+         * @return The asset (valid until the guard ends), or nullptr if it has expired
+         */
+        [[nodiscard]] T *get() const noexcept { return expired() ? nullptr : m_Asset; }
 
-        [[nodiscard]] std::string name() const noexcept { return m_Asset->name(); }
+        /**
+         * @brief Convert this weak reference to a strong reference. Safe on any thread, an asset the gc is removing reports expired.
+         * @return A strong reference to the asset, or an empty reference if it has expired
+         *
+         * @note Try not to call this frequently, as it does increment an atomic counter (and takes a registry lock if nothing else references the asset). Instead store the
+         * reference while you need it and remove when you don't anymore. If you only need to read the asset for a moment, use get inside an AssetReadGuard.
+         */
+        [[nodiscard]] AssetRef<T> lock() const {
+            if (m_Id == 0)
+                return AssetRef<T>(m_Asset); // not managed, nothing removes it behind our back
+            const AssetReadGuard guard;      // the asset can't be freed while we look at it, even if the gc removes it meanwhile
+            if (expired())
+                return AssetRef<T>();
+            if (m_Asset->tryIncRef() || AssetBase::reviveRef(m_Asset, m_Asset->manager(), m_Id))
+                return AssetRef<T>(m_Asset, typename AssetRef<T>::adopt_t{});
+            return AssetRef<T>();
+        }
+
+        [[nodiscard]] AssetHandle<T> handle() const noexcept { return AssetHandle<T>{m_Id}; }
+
+        [[nodiscard]] std::string_view name() const noexcept { return m_Asset->name(); }
 
         [[nodiscard]] asset_refcount_t refcount() const noexcept { return m_Asset->refcount(); }
 
         // ReSharper restore CppNonExplicitConvertingConstructor
 
       private:
-        T *m_Asset;
+        asset_id_t m_Id;
+        T         *m_Asset;
         friend class AssetRef<T>;
     };
 
@@ -413,18 +694,35 @@ namespace game {
 
       public:
         // ReSharper disable once CppNonExplicitConvertingConstructor
-        GenericAssetRef(AssetBase *asset) : m_Asset(asset) { m_Asset->incRef(); }
+        GenericAssetRef(AssetBase *asset) : m_Asset(asset) {
+            if (m_Asset != nullptr)
+                m_Asset->incRef();
+        }
 
+        /**
+         * @brief Cast to a typed reference (a type tag compare, see assetCast)
+         * @return A reference to the asset, or an empty reference if this is empty or the asset isn't a T
+         */
         template <asset_type T>
         AssetRef<T> as() const {
-            return AssetRef<T>(dynamic_cast<T *>(m_Asset));
+            return AssetRef<T>(assetCast<T>(m_Asset));
         }
 
         template<asset_type T>
         operator AssetRef<T>() const {
-            return AssetRef<T>(dynamic_cast<T *>(m_Asset));
+            return AssetRef<T>(assetCast<T>(m_Asset));
         }
 
+        /**
+         * @brief Boolean conversion. Returns true if this reference is not nullptr.
+         */
+        explicit operator bool() const noexcept { return m_Asset != nullptr; }
+
+        /**
+         * @return The referenced asset, or nullptr if this is empty
+         */
+        [[nodiscard]] AssetBase *get() const noexcept { return m_Asset; }
+
         void reset() {
             if (m_Asset) {
                 m_Asset->decRef();
@@ -442,13 +740,17 @@ namespace game {
          * @brief Copy constructor. Will change refcount.
          * @param o
          */
-        GenericAssetRef(const GenericAssetRef &o) : m_Asset(o.m_Asset) { m_Asset->incRef(); }
+        GenericAssetRef(const GenericAssetRef &o) : m_Asset(o.m_Asset) {
+            if (m_Asset != nullptr)
+                m_Asset->copyRef();
+        }
 
         GenericAssetRef(GenericAssetRef &&other) noexcept : m_Asset(other.m_Asset) { other.m_Asset = nullptr; }
 
         GenericAssetRef &operator=(GenericAssetRef &&other) noexcept {
             if (this == &other)
                 return *this;
+            reset();
             m_Asset       = other.m_Asset;
             other.m_Asset = nullptr;
             return *this;
@@ -460,12 +762,11 @@ namespace game {
          * @return
          */
         GenericAssetRef &operator=(const GenericAssetRef &rhs) noexcept {
-            if (m_Asset && m_Asset != rhs.m_Asset) {
-                m_Asset->decRef();
-            }
-
-            m_Asset = rhs.m_Asset;
-            m_Asset->incRef();
+            auto *asset = rhs.m_Asset; // rhs might be this
+            if (asset != nullptr)
+                asset->copyRef(); // before the release, in case this is the last other reference to the same asset
+            reset();
+            m_Asset = asset;
             return *this;
         }
     };
@@ -0,0 +1,232 @@
+//
+// Created by andy on 7/4/2025.
+//
+
+#include "asset_access_trace.hpp"
+
+#include "game/profiler.hpp"
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <concepts>
+#include <fstream>
+#include <shared_mutex>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace game {
+    namespace {
+        /**
+         * @brief Convert between native and little-endian byte order (the same swap both ways). Traces are little-endian on disk, whatever wrote them.
+         */
+        template <std::integral T>
+        constexpr T littleEndian(const T value) noexcept {
+            if constexpr (std::endian::native == std::endian::big)
+                return std::byteswap(value);
+            return value;
+        }
+
+        AccessTraceHeader littleEndian(const AccessTraceHeader &header) noexcept {
+            return {littleEndian(header.magic), littleEndian(header.version), littleEndian(header.fileCount), littleEndian(header.accessCount)};
+        }
+
+        AccessTraceEntry littleEndian(const AccessTraceEntry &entry) noexcept {
+            return {littleEndian(entry.file), littleEndian(entry.reserved), littleEndian(entry.offset), littleEndian(entry.size)};
+        }
+    } // namespace
+
+    AssetAccessTrace::AssetAccessTrace(const std::filesystem::path &path) {
+        const auto invalid = [&](const std::string &reason) { return std::invalid_argument("Invalid access trace '" + path.string() + "': " + reason); };
+
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            throw invalid("couldn't open file");
+
+        AccessTraceHeader header{};
+        if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)))
+            throw invalid("file is too small");
+        header = littleEndian(header);
+        if (header.magic != AccessTraceHeader::MAGIC)
+            throw invalid("bad magic");
+        if (header.version != AccessTraceHeader::VERSION)
+            throw invalid("unsupported version " + std::to_string(header.version));
+
+        m_Accesses.reserve(header.accessCount);
+        for (uint32_t i = 0; i < header.accessCount; i++) {
+            AccessTraceEntry entry{};
+            if (!in.read(reinterpret_cast<char *>(&entry), sizeof(entry)))
+                throw invalid("access table is out of bounds");
+            entry = littleEndian(entry);
+            if (entry.file >= header.fileCount)
+                throw invalid("access refers to a missing file");
+            m_Accesses.push_back({entry.file, entry.offset, entry.size});
+        }
+
+        m_Files.reserve(header.fileCount);
+        for (uint32_t i = 0; i < header.fileCount; i++) {
+            uint32_t length = 0;
+            if (!in.read(reinterpret_cast<char *>(&length), sizeof(length)))
+                throw invalid("file table is out of bounds");
+            length = littleEndian(length);
+            std::string file(length, '\0');
+            if (!in.read(file.data(), length))
+                throw invalid("file table is out of bounds");
+            m_Files.emplace_back(std::move(file));
+        }
+    }
+
+    void AssetAccessTrace::record(const std::filesystem::path &file, const uint64_t offset, const uint64_t size) {
+        std::lock_guard lock(m_Mutex);
+        auto [it, added] = m_FileIndices.try_emplace(file.string(), static_cast<uint32_t>(m_Files.size()));
+        if (added)
+            m_Files.push_back(file);
+
+        if (m_Recorded.insert({it->second, offset}).second)
+            m_Accesses.push_back({it->second, offset, size});
+    }
+
+    void AssetAccessTrace::save(const std::filesystem::path &path) const {
+        std::lock_guard lock(m_Mutex);
+
+        const auto header =
+            littleEndian(AccessTraceHeader{AccessTraceHeader::MAGIC, AccessTraceHeader::VERSION, static_cast<uint32_t>(m_Files.size()), static_cast<uint32_t>(m_Accesses.size())});
+
+        auto temp = path;
+        temp += ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            for (const auto &access : m_Accesses) {
+                const auto entry = littleEndian(AccessTraceEntry{access.file, 0, access.offset, access.size});
+                out.write(reinterpret_cast<const char *>(&entry), sizeof(entry));
+            }
+            for (const auto &file : m_Files) {
+                const auto     name   = file.string();
+                const uint32_t length = littleEndian(static_cast<uint32_t>(name.size()));
+                out.write(reinterpret_cast<const char *>(&length), sizeof(length));
+                out.write(name.data(), static_cast<std::streamsize>(name.size()));
+            }
+            if (!out)
+                throw std::runtime_error("Failed to write access trace '" + temp.string() + "'");
+        }
+        std::filesystem::rename(temp, path);
+
+        spdlog::info("Saved {} reads from {} files to access trace '{}'", m_Accesses.size(), m_Files.size(), path.string());
+    }
+
+    AssetPrefetcher::AssetPrefetcher(const std::filesystem::path &tracePath) {
+        if (!std::filesystem::exists(tracePath)) {
+            m_Finished = true;
+            return;
+        }
+
+        try {
+            m_Trace = std::make_unique<AssetAccessTrace>(tracePath);
+        } catch (const std::exception &e) {
+            spdlog::warn("Not prefetching assets: {}", e.what()); // the trace is rewritten at the end of this run
+            m_Finished = true;
+            return;
+        }
+
+        m_Thread = std::jthread([this](std::stop_token stopToken) { replay(stopToken); });
+    }
+
+    AssetPrefetcher::~AssetPrefetcher() {
+        if (m_Thread.joinable()) {
+            m_Thread.request_stop();
+            m_Thread.join();
+        }
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    // reads closer together than this are prefetched as one range, so neighbouring entries of a pack don't each cost a syscall
+    static constexpr uint64_t PREFETCH_MERGE_GAP = 4096;
+
+    void AssetPrefetcher::replay(const std::stop_token stopToken) {
+        GAME_PROFILE_THREAD("asset prefetch");
+        GAME_PROFILE_ZONE("AssetPrefetcher::replay");
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<int> fds(m_Trace->files().size(), -2); // -2 is not opened yet, -1 couldn't be opened
+        uint64_t         bytes  = 0;
+        std::size_t      ranges = 0;
+
+        const auto &accesses = m_Trace->accesses();
+        for (std::size_t i = 0; i < accesses.size() && !stopToken.stop_requested();) {
+            const auto file   = accesses[i].file;
+            const auto offset = accesses[i].offset;
+            auto       end    = offset + accesses[i].size;
+            for (++i; i < accesses.size() && accesses[i].file == file && accesses[i].offset >= offset && accesses[i].offset <= end + PREFETCH_MERGE_GAP; ++i) {
+                end = std::max(end, accesses[i].offset + accesses[i].size);
+            }
+
+            if (fds[file] == -2)
+                fds[file] = open(m_Trace->files()[file].c_str(), O_RDONLY | O_CLOEXEC);
+            if (fds[file] < 0)
+                continue;
+
+#ifdef __linux__
+            // readahead doesn't return until the pages are queued, so the ranges are read in the order the loaders will want them
+            readahead(fds[file], static_cast<off_t>(offset), end - offset);
+#elif !defined(__APPLE__)
+            posix_fadvise(fds[file], static_cast<off_t>(offset), static_cast<off_t>(end - offset), POSIX_FADV_WILLNEED);
+#else
+            radvisory advisory{static_cast<off_t>(offset), static_cast<int>(std::min<uint64_t>(end - offset, INT32_MAX))};
+            fcntl(fds[file], F_RDADVISE, &advisory);
+#endif
+            bytes += end - offset;
+            ranges++;
+        }
+
+        for (const int fd : fds) {
+            if (fd >= 0)
+                close(fd);
+        }
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        spdlog::debug("Prefetched {} bytes of assets in {} ranges ({}ms)", bytes, ranges, elapsed.count());
+        m_Finished.store(true, std::memory_order_release);
+    }
+#else
+    void AssetPrefetcher::replay(std::stop_token) {
+        m_Finished.store(true, std::memory_order_release); // nothing to hint with
+    }
+#endif
+
+    static std::shared_mutex                 s_TraceMutex;
+    static std::unique_ptr<AssetAccessTrace> s_Trace;
+    static std::filesystem::path             s_TracePath;
+
+    void beginAccessTrace(const std::filesystem::path &path) {
+        auto            trace = std::make_unique<AssetAccessTrace>();
+        std::lock_guard lock(s_TraceMutex);
+        s_Trace     = std::move(trace);
+        s_TracePath = path;
+    }
+
+    void saveAccessTrace() {
+        std::shared_lock lock(s_TraceMutex);
+        if (s_Trace == nullptr)
+            return;
+
+        try {
+            s_Trace->save(s_TracePath);
+        } catch (const std::exception &e) {
+            spdlog::warn("Couldn't save the access trace: {}", e.what()); // the next launch just starts cold
+        }
+    }
+
+    namespace asset_util {
+        void recordAccess(const std::filesystem::path &file, const uint64_t offset, const uint64_t size) {
+            std::shared_lock lock(s_TraceMutex);
+            if (s_Trace != nullptr)
+                s_Trace->record(file, offset, size);
+        }
+    } // namespace asset_util
+} // namespace game
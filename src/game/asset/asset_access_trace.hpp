@@ -0,0 +1,172 @@
+//
+// Created by andy on 7/4/2025.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace game {
+    /**
+     * @brief On-disk header of an access trace (all values little-endian, converted on read and write so a trace means the same on any machine).
+     */
+    struct AccessTraceHeader {
+        static constexpr uint32_t MAGIC   = 0x54414754; // "TGAT"
+        static constexpr uint32_t VERSION = 1;
+
+        uint32_t magic;
+        uint32_t version;
+        uint32_t fileCount;
+        uint32_t accessCount;
+    };
+
+    static_assert(sizeof(AccessTraceHeader) == 16);
+
+    /**
+     * @brief A read in an access trace. The accesses follow the header in the order they happened, followed by the file table (fileCount paths, each a 32-bit length and
+     * then the path).
+     */
+    struct AccessTraceEntry {
+        uint32_t file; // index into the file table
+        uint32_t reserved;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    static_assert(sizeof(AccessTraceEntry) == 24);
+
+    /**
+     * @brief The ordered list of byte ranges read from asset files during a run.
+     *
+     * Files are recorded by the path they were actually read from (a pack file, a database source or a loose file), so a trace can be replayed without the asset database or
+     * packs being open. Each range is recorded once, the first time it is read.
+     *
+     * record may be called from any thread.
+     */
+    class AssetAccessTrace {
+      public:
+        struct Access {
+            uint32_t file; // index into files()
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        AssetAccessTrace() = default;
+
+        /**
+         * @brief Read a trace file
+         * @throws std::invalid_argument if the file can't be read or isn't a valid trace
+         */
+        explicit AssetAccessTrace(const std::filesystem::path &path);
+
+        AssetAccessTrace(const AssetAccessTrace &other)                = delete;
+        AssetAccessTrace(AssetAccessTrace &&other) noexcept            = delete;
+        AssetAccessTrace &operator=(const AssetAccessTrace &other)     = delete;
+        AssetAccessTrace &operator=(AssetAccessTrace &&other) noexcept = delete;
+
+        /**
+         * @brief Record a read (ignored if the same range of the same file was already recorded)
+         * @param file The full path of the file read
+         * @param offset Where the read starts in the file
+         * @param size How many bytes were read
+         */
+        void record(const std::filesystem::path &file, uint64_t offset, uint64_t size);
+
+        /**
+         * @brief Write the trace. The file is written next to the old one and renamed over it.
+         * @throws std::runtime_error if the file can't be written
+         */
+        void save(const std::filesystem::path &path) const;
+
+        /**
+         * @brief The recorded files (only safe to call once nothing is recording any more)
+         */
+        [[nodiscard]] inline const std::vector<std::filesystem::path> &files() const noexcept { return m_Files; }
+
+        /**
+         * @brief The recorded reads, in the order they happened (only safe to call once nothing is recording any more)
+         */
+        [[nodiscard]] inline const std::vector<Access> &accesses() const noexcept { return m_Accesses; }
+
+      private:
+        struct RangeKey {
+            uint32_t file;
+            uint64_t offset;
+
+            bool operator==(const RangeKey &) const = default;
+        };
+
+        struct RangeKeyHash {
+            inline std::size_t operator()(const RangeKey &key) const noexcept { return std::hash<uint64_t>{}(key.offset * 31 + key.file); }
+        };
+
+        mutable std::mutex                         m_Mutex;
+        std::vector<std::filesystem::path>         m_Files;
+        std::unordered_map<std::string, uint32_t>  m_FileIndices;
+        std::vector<Access>                        m_Accesses;
+        std::unordered_set<RangeKey, RangeKeyHash> m_Recorded;
+    };
+
+    /**
+     * @brief Replays an access trace in the background, asking the OS to read each range into the page cache (readahead on linux, posix_fadvise elsewhere) in the order the
+     * last run read them. Started before anything is loaded, it stays ahead of the loaders, so their reads hit the page cache even on a cold start.
+     *
+     * Prefetching is only a hint: files that are missing or can't be opened are skipped, and a missing or invalid trace prefetches nothing.
+     */
+    class AssetPrefetcher {
+      public:
+        /**
+         * @param tracePath The full path to the trace written by the last run (it is read before this returns, so the file can be overwritten straight away)
+         */
+        explicit AssetPrefetcher(const std::filesystem::path &tracePath);
+
+        /**
+         * @brief Stops prefetching (ranges that haven't been prefetched yet are skipped)
+         */
+        ~AssetPrefetcher();
+
+        AssetPrefetcher(const AssetPrefetcher &other)                = delete;
+        AssetPrefetcher(AssetPrefetcher &&other) noexcept            = delete;
+        AssetPrefetcher &operator=(const AssetPrefetcher &other)     = delete;
+        AssetPrefetcher &operator=(AssetPrefetcher &&other) noexcept = delete;
+
+        /**
+         * @return If the whole trace has been replayed
+         */
+        [[nodiscard]] inline bool finished() const noexcept { return m_Finished.load(std::memory_order_acquire); }
+
+      private:
+        std::unique_ptr<AssetAccessTrace> m_Trace;
+        std::atomic<bool>                 m_Finished = false;
+        std::jthread                      m_Thread;
+
+        void replay(std::stop_token stopToken);
+    };
+
+    /**
+     * @brief Start recording the asset files read by asset_util::readAsset (replacing any trace which is already being recorded)
+     * @param path The full path saveAccessTrace writes the trace to
+     */
+    void beginAccessTrace(const std::filesystem::path &path);
+
+    /**
+     * @brief Save the trace being recorded, if there is one (see AssetAccessTrace::save). Failures are logged rather than thrown.
+     */
+    void saveAccessTrace();
+
+    namespace asset_util {
+        /**
+         * @brief Record a read with the trace begun by beginAccessTrace (does nothing if no trace is being recorded)
+         */
+        void recordAccess(const std::filesystem::path &file, uint64_t offset, uint64_t size);
+    } // namespace asset_util
+} // namespace game
@@ -5,33 +5,250 @@
 #include "asset_bundle.hpp"
 
 #include "game/asset/asset_manager.hpp"
+#include "game/asset/asset_metadata_cache.hpp"
+#include "game/asset/asset_read_batch.hpp"
+
+#include <algorithm>
+#include <unordered_map>
 
 namespace game {
     AssetBundle::AssetBundle(std::vector<GenericAssetRef> refs, const asset_id_t assetId, const std::string &name) : Asset(assetId, name), m_Refs(std::move(refs)) {}
 
+    bool AssetBundle::swapContents(AssetBase &other) {
+        auto *bundle = assetCast<AssetBundle>(&other);
+        if (bundle == nullptr)
+            return false;
+
+        std::swap(m_Refs, bundle->m_Refs); // entries dropped from the bundle are released when the old version is destroyed
+        return true;
+    }
+
+    namespace {
+        /**
+         * @brief Collect the files a manifest points its loader at: every "file" string at any depth (unlinked shaders name their spir-v at the top, linked shaders in each
+         * stage)
+         */
+        void collectReferencedFiles(const nlohmann::json &json, std::vector<std::string> &out) {
+            if (json.is_object()) {
+                for (const auto &[key, value] : json.items()) {
+                    if (key == "file" && value.is_string())
+                        out.push_back(value.get<std::string>());
+                    else
+                        collectReferencedFiles(value, out);
+                }
+            } else if (json.is_array()) {
+                for (const auto &value : json) {
+                    collectReferencedFiles(value, out);
+                }
+            }
+        }
+
+        /**
+         * @brief A single entry of a bundle in the bundle's dependency graph.
+         */
+        struct BundleNode {
+            const GenericAssetLoader<std::nullptr_t> *loader;
+            std::string                               path;
+            std::vector<std::string>                  dependencyPaths;
+
+            std::vector<std::size_t>       dependents;
+            std::size_t                    remainingDependencies = 0;
+            bool                           dependencyFailed      = false;
+            std::optional<GenericAssetRef> ref;
+        };
+
+        /**
+         * @brief Shared state for scheduling the loads of a bundle's entries.
+         */
+        struct BundleLoadState {
+            std::vector<BundleNode> nodes;
+            AssetManager           *assetManager;
+
+            std::mutex         mutex;
+            std::size_t        outstanding = 0;
+            std::exception_ptr error;
+            std::promise<void> done;
+
+            void submit(std::size_t index);
+            void finish(std::size_t index, bool success);
+        };
+
+        void BundleLoadState::submit(const std::size_t index) {
+            assetManager->loadPool().submit([this, index] {
+                auto &node = nodes[index];
+                try {
+                    node.ref = assetManager->loadFromFileUsing(node.loader, node.path);
+                } catch (...) {
+                    {
+                        std::lock_guard lock(mutex);
+                        if (!error)
+                            error = std::current_exception();
+                    }
+                    finish(index, false);
+                    return;
+                }
+                finish(index, true);
+            });
+        }
+
+        void BundleLoadState::finish(const std::size_t index, const bool success) {
+            std::vector<std::size_t> ready;
+            bool                     complete;
+            {
+                std::lock_guard lock(mutex);
+                for (const auto dependent : nodes[index].dependents) {
+                    auto &node = nodes[dependent];
+                    if (!success)
+                        node.dependencyFailed = true;
+                    if (--node.remainingDependencies == 0)
+                        ready.push_back(dependent);
+                }
+                complete = --outstanding == 0;
+            }
+
+            for (const auto dependent : ready) {
+                if (nodes[dependent].dependencyFailed) {
+                    finish(dependent, false); // never loaded, but it still has to be accounted for
+                } else {
+                    submit(dependent);
+                }
+            }
+
+            // the last node to finish has nothing left to schedule, so setting this can't race with the submissions above
+            if (complete)
+                done.set_value();
+        }
+    } // namespace
+
     AssetBundle *AssetBundleLoader::load(
         const nlohmann::json &json, [[maybe_unused]] const std::nullptr_t &options, const asset_id_t id, const std::string &name, const AssetLoaderContext &loaderContext
     ) const {
-        std::vector<GenericAssetRef> refs;
         if (!json.is_object())
             throw std::invalid_argument("Failed to parse asset bundle json: root must be an object");
-        for (const auto &entry : json.items()) {
+        if (!json.contains("assets") || !json["assets"].is_object())
+            throw std::invalid_argument("Failed to parse asset bundle json: assets must be an object mapping loader names to lists of assets");
+
+        BundleLoadState state;
+        state.assetManager = loaderContext.assetManager;
+
+        for (const auto &entry : json["assets"].items()) {
             if (!entry.value().is_array()) {
                 throw std::invalid_argument("Failed to parse asset bundle json: each set of assets must be an array.");
             }
 
             const auto loader = loaderContext.assetManager->getLoader(entry.key());
-            for (const auto &assetPath : entry.value()) {
-                if (!assetPath.is_string()) {
+            for (const auto &asset : entry.value()) {
+                BundleNode node{loader};
+                if (asset.is_string()) {
+                    node.path = asset.get<std::string>();
+                } else if (asset.is_object() && asset.contains("path")) {
+                    node.path = asset["path"].get<std::string>();
+                    if (asset.contains("depends")) {
+                        node.dependencyPaths = asset["depends"].get<std::vector<std::string>>();
+                    }
+                } else {
                     throw std::invalid_argument(
-                        "Failed to parse asset bundle json: each entry in an asset list must be a string containing the path to the asset (relative to the assets folder)."
+                        "Failed to parse asset bundle json: each entry in an asset list must be a string containing the path to the asset (relative to the assets folder), or "
+                        "an object with a path and an optional list of dependencies."
                     );
                 }
 
-                refs.push_back(std::move(loaderContext.assetManager->loadFromFileUsing(loader, assetPath.get<std::string>())));
+                state.nodes.push_back(std::move(node));
             }
         }
 
+        // build the dependency graph (dependencies must be other entries in the same bundle)
+        std::unordered_map<std::string, std::size_t> indices;
+        for (std::size_t i = 0; i < state.nodes.size(); ++i) {
+            indices.insert({state.nodes[i].path, i});
+        }
+
+        for (std::size_t i = 0; i < state.nodes.size(); ++i) {
+            for (const auto &dependencyPath : state.nodes[i].dependencyPaths) {
+                const auto it = indices.find(dependencyPath);
+                if (it == indices.end())
+                    throw std::invalid_argument("Failed to parse asset bundle json: '" + state.nodes[i].path + "' depends on '" + dependencyPath + "' which is not in the bundle");
+                state.nodes[it->second].dependents.push_back(i);
+                ++state.nodes[i].remainingDependencies;
+            }
+        }
+
+        // reject cycles up front (otherwise the nodes in the cycle would never be scheduled)
+        {
+            std::vector<std::size_t> remaining(state.nodes.size());
+            std::vector<std::size_t> ready;
+            for (std::size_t i = 0; i < state.nodes.size(); ++i) {
+                remaining[i] = state.nodes[i].remainingDependencies;
+                if (remaining[i] == 0)
+                    ready.push_back(i);
+            }
+
+            std::size_t visited = 0;
+            while (!ready.empty()) {
+                const auto i = ready.back();
+                ready.pop_back();
+                ++visited;
+                for (const auto dependent : state.nodes[i].dependents) {
+                    if (--remaining[dependent] == 0)
+                        ready.push_back(dependent);
+                }
+            }
+
+            if (visited != state.nodes.size())
+                throw std::invalid_argument("Failed to load asset bundle '" + name + "': dependency cycle between bundle entries");
+        }
+
+        if (!state.nodes.empty()) {
+            // read every entry that isn't loaded yet in one batch up front, so the loads below don't each wait on their own read
+            std::vector<std::string> unloaded;
+            for (const auto &node : state.nodes) {
+                if (!loaderContext.assetManager->hasAsset(node.path))
+                    unloaded.push_back(node.path);
+            }
+            const asset_util::AssetReadBatch manifests(unloaded);
+
+            // the manifests are in memory now, so read the files they point at (spir-v, textures) in a second batch. Looked up in the batch rather than with readAsset, which
+            // would record the manifests as files the bundle itself was loaded from.
+            std::vector<std::string> referenced;
+            for (const auto &path : unloaded) {
+                const auto manifest = asset_util::AssetReadBatch::find(path);
+                if (!manifest)
+                    continue; // in a pack (already mapped) or unreadable, which the entry's loader reports
+                try {
+                    collectReferencedFiles(asset_util::parseMetadata(manifest->data), referenced); // cached, so the loader doesn't parse it again
+                } catch (const std::exception &) {
+                    // the entry's loader reports it
+                }
+            }
+            std::ranges::sort(referenced);
+            referenced.erase(std::ranges::unique(referenced).begin(), referenced.end());
+            const asset_util::AssetReadBatch sources(referenced);
+
+            state.outstanding = state.nodes.size();
+            const auto done   = state.done.get_future();
+
+            std::vector<std::size_t> roots;
+            for (std::size_t i = 0; i < state.nodes.size(); ++i) {
+                if (state.nodes[i].remainingDependencies == 0)
+                    roots.push_back(i);
+            }
+            for (const auto i : roots) {
+                state.submit(i);
+            }
+
+            // help out while waiting, since this bundle might itself be loading on a pool worker
+            loaderContext.assetManager->loadPool().wait(done);
+
+            if (state.error)
+                std::rethrow_exception(state.error);
+        }
+
+        std::vector<GenericAssetRef> refs;
+        refs.reserve(state.nodes.size());
+        for (auto &node : state.nodes) {
+            refs.push_back(std::move(node.ref.value()));
+        }
+
         return new AssetBundle(std::move(refs), id, name);
     }
 } // namespace game
@@ -14,11 +14,21 @@ namespace game {
     public:
         explicit AssetBundle(std::vector<GenericAssetRef> refs, asset_id_t assetId = 0, const std::string &name = "");
 
+        bool swapContents(AssetBase &other) override;
+
+        [[nodiscard]] inline AssetFootprint footprint() const noexcept override { return {sizeof(AssetBundle) + m_Refs.capacity() * sizeof(GenericAssetRef), 0}; }
+
     private:
         std::vector<GenericAssetRef> m_Refs;
 
     };
 
+    /**
+     * @brief Loader for asset bundles.
+     *
+     * Bundle entries are loaded in parallel on the asset load pool. Entries may list other entries of the same bundle they depend on, in which case they are only loaded once
+     * those dependencies are resident. The bundle itself is only created once every entry has loaded.
+     */
     class AssetBundleLoader final : public JsonAssetLoader<AssetBundle, std::nullptr_t> {
       public:
         AssetBundle *load(
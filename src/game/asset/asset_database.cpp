@@ -0,0 +1,168 @@
+//
+// Created by andy on 6/25/2025.
+//
+
+#include "asset_database.hpp"
+
+#include "game/asset/asset_loader.hpp"
+#include "spdlog/spdlog.h"
+
+#include <memory>
+#include <ranges>
+#include <shared_mutex>
+#include <stdexcept>
+
+#ifdef TILEGAME_ASSET_DATABASE
+#include <sqlite3.h>
+#endif
+
+namespace game {
+#ifdef TILEGAME_ASSET_DATABASE
+    static constexpr auto CREATE_ASSETS_TABLE =
+        "CREATE TABLE IF NOT EXISTS assets (id UUID PRIMARY KEY, path VARCHAR(255) UNIQUE NOT NULL, source_kind INTEGER NOT NULL, source_path VARCHAR(255) NOT NULL)";
+
+    AssetDatabase::AssetDatabase(const std::filesystem::path &path) : m_Path(path) {
+        if (sqlite3_open_v2(path.string().c_str(), &m_Db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK) {
+            const std::string message = m_Db != nullptr ? sqlite3_errmsg(m_Db) : "out of memory";
+            sqlite3_close(m_Db);
+            throw std::runtime_error("Couldn't open asset database '" + path.string() + "': " + message);
+        }
+
+        if (sqlite3_exec(m_Db, CREATE_ASSETS_TABLE, nullptr, nullptr, nullptr) != SQLITE_OK) {
+            const std::string message = sqlite3_errmsg(m_Db);
+            sqlite3_close(m_Db);
+            throw std::runtime_error("Couldn't create the assets table in '" + path.string() + "': " + message);
+        }
+
+        try {
+            reload();
+        } catch (...) {
+            for (const auto &stmt : m_Statements | std::views::values) {
+                sqlite3_finalize(stmt);
+            }
+            sqlite3_close(m_Db);
+            throw;
+        }
+    }
+
+    AssetDatabase::~AssetDatabase() {
+        for (const auto &stmt : m_Statements | std::views::values) {
+            sqlite3_finalize(stmt);
+        }
+        sqlite3_close(m_Db);
+    }
+
+    void AssetDatabase::reload() {
+        const auto stmt = statement("SELECT path, source_kind, source_path FROM assets");
+
+        decltype(m_Index) index;
+        int               result;
+        while ((result = sqlite3_step(stmt)) == SQLITE_ROW) {
+            const auto path       = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+            const auto kind       = static_cast<AssetSourceKind>(sqlite3_column_int(stmt, 1));
+            const auto sourcePath = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2));
+            if (path == nullptr || sourcePath == nullptr)
+                continue; // NOT NULL in the schema, but don't trust the file
+
+            index.insert_or_assign(path, makeSource(kind, sourcePath));
+        }
+        if (result != SQLITE_DONE)
+            fail("reading the assets table");
+
+        sqlite3_reset(stmt);
+        m_Index = std::move(index);
+    }
+
+    const AssetSource *AssetDatabase::resolve(const std::string_view path) const {
+        if (const auto it = m_Index.find(path); it != m_Index.end()) {
+            return &it->second;
+        }
+        return nullptr;
+    }
+
+    void AssetDatabase::put(const std::string &path, const AssetSourceKind kind, const std::string &sourcePath) {
+        auto source = makeSource(kind, sourcePath);
+
+        const auto stmt = statement(
+            "INSERT INTO assets (id, path, source_kind, source_path) VALUES (lower(hex(randomblob(16))), ?1, ?2, ?3) "
+            "ON CONFLICT(path) DO UPDATE SET source_kind = excluded.source_kind, source_path = excluded.source_path"
+        );
+        sqlite3_bind_text(stmt, 1, path.c_str(), static_cast<int>(path.size()), SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 2, static_cast<int>(kind));
+        sqlite3_bind_text(stmt, 3, sourcePath.c_str(), static_cast<int>(sourcePath.size()), SQLITE_STATIC);
+        if (sqlite3_step(stmt) != SQLITE_DONE)
+            fail("adding '" + path + "'");
+        sqlite3_reset(stmt);
+
+        m_Index.insert_or_assign(path, std::move(source));
+    }
+
+    void AssetDatabase::remove(const std::string &path) {
+        const auto stmt = statement("DELETE FROM assets WHERE path = ?1");
+        sqlite3_bind_text(stmt, 1, path.c_str(), static_cast<int>(path.size()), SQLITE_STATIC);
+        if (sqlite3_step(stmt) != SQLITE_DONE)
+            fail("removing '" + path + "'");
+        sqlite3_reset(stmt);
+
+        m_Index.erase(path);
+    }
+
+    sqlite3_stmt *AssetDatabase::statement(const std::string &sql) {
+        if (const auto it = m_Statements.find(sql); it != m_Statements.end()) {
+            sqlite3_reset(it->second);
+            sqlite3_clear_bindings(it->second);
+            return it->second;
+        }
+
+        sqlite3_stmt *stmt = nullptr;
+        if (sqlite3_prepare_v3(m_Db, sql.c_str(), static_cast<int>(sql.size() + 1), SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK)
+            fail("preparing '" + sql + "'");
+        m_Statements.emplace(sql, stmt);
+        return stmt;
+    }
+
+    AssetSource AssetDatabase::makeSource(const AssetSourceKind kind, const std::string &sourcePath) const {
+        switch (kind) {
+        case AssetSourceKind::File:
+        case AssetSourceKind::Compressed:
+            return AssetSource{.kind = kind, .sourcePath = assetPath(sourcePath)};
+        case AssetSourceKind::Pack: {
+            const auto full = assetPath(sourcePath);
+            return AssetSource{.kind = kind, .sourcePath = full, .pack = &mountAssetPack(full)};
+        }
+        }
+        throw std::invalid_argument("Asset database '" + m_Path.string() + "' has an unknown source kind " + std::to_string(static_cast<int>(kind)) + " for '" + sourcePath + "'");
+    }
+
+    void AssetDatabase::fail(const std::string_view what) const {
+        throw std::runtime_error("Asset database '" + m_Path.string() + "' failed " + std::string(what) + ": " + sqlite3_errmsg(m_Db));
+    }
+
+    static std::shared_mutex              s_DatabaseMutex;
+    static std::unique_ptr<AssetDatabase> s_Database;
+
+    void openAssetDatabase(const std::filesystem::path &path) {
+        auto            database = std::make_unique<AssetDatabase>(path);
+        std::lock_guard lock(s_DatabaseMutex);
+        s_Database = std::move(database);
+    }
+
+    std::optional<AssetSource> resolveAssetSource(const std::string_view path) {
+        std::shared_lock lock(s_DatabaseMutex);
+        if (s_Database == nullptr)
+            return std::nullopt;
+        if (const auto source = s_Database->resolve(path)) {
+            return *source;
+        }
+        return std::nullopt;
+    }
+#else
+    void openAssetDatabase(const std::filesystem::path &path) {
+        spdlog::warn("Not opening asset database '{}': built without TILEGAME_ASSET_DATABASE, assets resolve through packs and the assets directory", path.string());
+    }
+
+    std::optional<AssetSource> resolveAssetSource(const std::string_view) {
+        return std::nullopt;
+    }
+#endif
+} // namespace game
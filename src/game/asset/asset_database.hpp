@@ -0,0 +1,118 @@
+//
+// Created by andy on 6/25/2025.
+//
+
+#pragma once
+
+#include "game/asset/asset_pack.hpp"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace game {
+    /**
+     * @brief Values of the source_kind column in the assets table
+     */
+    enum class AssetSourceKind : int {
+        File       = 0,
+        Compressed = 1,
+        Pack       = 2,
+    };
+
+    /**
+     * @brief Where the data for an asset path actually lives.
+     */
+    struct AssetSource {
+        AssetSourceKind       kind;
+        std::filesystem::path sourcePath; // full path to the file (or pack) holding the asset
+        const AssetPack      *pack = nullptr; // only set for AssetSourceKind::Pack
+    };
+
+    /**
+     * @brief The sqlite asset database (see asset_format.md for the schema).
+     *
+     * The whole path index is read in one query when the database is opened, so resolving an asset afterwards is a hash lookup and never touches the filesystem. Prepared
+     * statements are cached by their sql text and reused.
+     *
+     * resolve may be called from any thread, but put/remove/reload must not run concurrently with anything else on the same database.
+     *
+     * Only built with TILEGAME_ASSET_DATABASE (the cmake option of the same name, which needs the system sqlite3). Without it there is no AssetDatabase, openAssetDatabase
+     * just logs a warning and resolveAssetSource never finds anything.
+     */
+    class AssetDatabase {
+      public:
+        /**
+         * @param path The full path to the database file (created with an empty assets table if it doesn't exist)
+         * @throws std::runtime_error if the database can't be opened
+         */
+        explicit AssetDatabase(const std::filesystem::path &path);
+        ~AssetDatabase();
+
+        AssetDatabase(const AssetDatabase &other)                = delete;
+        AssetDatabase(AssetDatabase &&other) noexcept            = delete;
+        AssetDatabase &operator=(const AssetDatabase &other)     = delete;
+        AssetDatabase &operator=(AssetDatabase &&other) noexcept = delete;
+
+        /**
+         * @brief Re-read the whole path index from the database
+         */
+        void reload();
+
+        /**
+         * @param path The path of the asset relative to the assets directory (with forward slashes)
+         * @return Where the asset lives, or nullptr if the database doesn't know the asset
+         */
+        [[nodiscard]] const AssetSource *resolve(std::string_view path) const;
+
+        /**
+         * @brief Add or replace an asset in the database (and the in-memory index)
+         * @param path The path of the asset relative to the assets directory
+         * @param kind The kind of source
+         * @param sourcePath The source file (or pack) relative to the assets directory
+         */
+        void put(const std::string &path, AssetSourceKind kind, const std::string &sourcePath);
+
+        void remove(const std::string &path);
+
+        [[nodiscard]] inline std::size_t size() const noexcept { return m_Index.size(); }
+
+      private:
+        struct StringHash {
+            using is_transparent = void;
+
+            inline std::size_t operator()(const std::string_view s) const noexcept { return std::hash<std::string_view>{}(s); }
+        };
+
+        std::filesystem::path                                                    m_Path;
+        sqlite3                                                                 *m_Db = nullptr;
+        std::unordered_map<std::string, sqlite3_stmt *>                          m_Statements;
+        std::unordered_map<std::string, AssetSource, StringHash, std::equal_to<>> m_Index;
+
+        /**
+         * @brief Get a prepared statement for some sql, preparing it the first time it is used. The statement is reset and has its bindings cleared.
+         */
+        sqlite3_stmt *statement(const std::string &sql);
+
+        [[nodiscard]] AssetSource makeSource(AssetSourceKind kind, const std::string &sourcePath) const;
+
+        [[noreturn]] void fail(std::string_view what) const;
+    };
+
+    /**
+     * @brief Open the asset database. Once it is open, asset reads resolve their source through it before falling back to packs and the assets directory.
+     * @param path The full path to the database file
+     */
+    void openAssetDatabase(const std::filesystem::path &path);
+
+    /**
+     * @param path The path of the asset relative to the assets directory
+     * @return The asset's source, or nullopt if there is no database open or it doesn't know the asset
+     */
+    std::optional<AssetSource> resolveAssetSource(std::string_view path);
+} // namespace game
@@ -0,0 +1,99 @@
+//
+// Created by andy on 7/11/2025.
+//
+
+#include "asset_epoch.hpp"
+
+#include "game/asset/asset.hpp"
+
+namespace game {
+    struct AssetEpoch::RecordOwner {
+        Record *record = nullptr;
+
+        ~RecordOwner() {
+            if (record == nullptr)
+                return;
+            record->epoch.store(QUIESCENT, std::memory_order::release);
+            record->owned.clear(std::memory_order::release);
+        }
+    };
+
+    thread_local AssetEpoch::RecordOwner AssetEpoch::s_Owner;
+
+    bool AssetEpoch::tryAdvance() noexcept {
+        std::atomic_thread_fence(std::memory_order::seq_cst); // pairs with the fence readers make after announcing
+        auto epoch = s_Epoch.load(std::memory_order::seq_cst);
+        for (const Record *record = s_Records.load(std::memory_order::acquire); record != nullptr; record = record->next) {
+            const auto announced = record->epoch.load(std::memory_order::acquire);
+            if (announced != QUIESCENT && announced != epoch)
+                return false; // still reading in an older epoch
+        }
+        return s_Epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order::seq_cst);
+    }
+
+    AssetEpoch::Record *AssetEpoch::acquireRecord() {
+        Record *record = nullptr;
+        for (auto *existing = s_Records.load(std::memory_order::acquire); existing != nullptr; existing = existing->next) {
+            if (!existing->owned.test_and_set(std::memory_order::acquire)) {
+                record = existing; // left behind by a thread that exited
+                break;
+            }
+        }
+
+        if (record == nullptr) {
+            record = new Record();
+            record->owned.test_and_set(std::memory_order::relaxed);
+            auto *head = s_Records.load(std::memory_order::relaxed);
+            do {
+                record->next = head;
+            } while (!s_Records.compare_exchange_weak(head, record, std::memory_order::release, std::memory_order::relaxed));
+        }
+
+        s_Owner.record = record;
+        s_Record       = record;
+        return record;
+    }
+
+    void AssetLimbo::retire(AssetBase *asset) {
+        // the asset was unlinked before this, so any reader that found it announced this epoch or an older one
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        const auto epoch = AssetEpoch::current();
+        if (m_Lists.empty() || m_Lists.back().epoch != epoch)
+            m_Lists.push_back(List{epoch, {}});
+        m_Lists.back().assets.push_back(asset);
+    }
+
+    std::size_t AssetLimbo::reclaim() {
+        if (m_Lists.empty())
+            return 0;
+
+        // twice, so with no readers around everything retired so far is freed now
+        if (AssetEpoch::tryAdvance())
+            AssetEpoch::tryAdvance();
+
+        std::size_t freed = 0;
+        while (!m_Lists.empty() && AssetEpoch::reclaimable(m_Lists.front().epoch)) {
+            auto list = std::move(m_Lists.front());
+            m_Lists.pop_front();
+            freed += free(list);
+        }
+        return freed;
+    }
+
+    std::size_t AssetLimbo::reclaimAll() {
+        std::size_t freed = 0;
+        while (!m_Lists.empty()) {
+            auto list = std::move(m_Lists.front());
+            m_Lists.pop_front();
+            freed += free(list);
+        }
+        return freed;
+    }
+
+    std::size_t AssetLimbo::free(List &list) {
+        for (const auto *asset : list.assets) {
+            delete asset; // releases its own references, which queues anything that was only alive because of this asset
+        }
+        return list.assets.size();
+    }
+} // namespace game
@@ -0,0 +1,140 @@
+//
+// Created by andy on 7/11/2025.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace game {
+    class AssetBase;
+
+    /**
+     * @brief Epoch based reclamation for assets, which lets any thread read assets it holds no reference to without taking a lock.
+     *
+     * Readers enter an AssetReadGuard, which announces the global epoch they saw. The asset manager's gc doesn't delete the assets it removes straight away, it retires them
+     * to an AssetLimbo tagged with the current epoch. The epoch only advances once every thread inside a guard has announced it, so once it is two past an asset's tag no
+     * guard that could have seen the asset is still open, and the asset is freed.
+     *
+     * Each thread gets a record the first time it enters a guard, which goes back to a shared list for another thread to reuse when it exits. Records are never freed, so the
+     * gc walks the list without a lock.
+     */
+    class AssetEpoch {
+      public:
+        using epoch_t = uint64_t;
+
+        /**
+         * @return The global epoch
+         */
+        [[nodiscard]] static inline epoch_t current() noexcept { return s_Epoch.load(std::memory_order::seq_cst); }
+
+        /**
+         * @brief Advance the global epoch if every thread inside a guard has seen the current one
+         * @return If the epoch advanced
+         */
+        static bool tryAdvance() noexcept;
+
+        /**
+         * @return If nothing retired in an epoch can still be seen by a reader
+         */
+        [[nodiscard]] static inline bool reclaimable(const epoch_t retired) noexcept { return current() >= retired + 2; }
+
+      private:
+        friend class AssetReadGuard;
+
+        static constexpr epoch_t QUIESCENT = 0; // announced outside of guards, the global epoch starts above it
+
+        struct alignas(64) Record { // one per cache line, so the gc reading them doesn't bounce readers announcing epochs
+            std::atomic<epoch_t> epoch = QUIESCENT;
+            std::atomic_flag     owned;
+            uint32_t             depth = 0; // guards nest, only the outermost one announces
+            Record              *next  = nullptr;
+        };
+
+        /**
+         * @return The current thread's record, taking one from the list (or adding one) the first time it's called on the thread
+         */
+        static Record *acquireRecord();
+
+        /**
+         * @brief Hands the thread's record back to the list when the thread exits
+         */
+        struct RecordOwner;
+
+        static inline std::atomic<epoch_t>  s_Epoch   = QUIESCENT + 1;
+        static inline std::atomic<Record *> s_Records = nullptr;
+
+        static thread_local inline Record *s_Record = nullptr;
+        static thread_local RecordOwner    s_Owner;
+    };
+
+    /**
+     * @brief Keeps every asset resolved while it exists from being freed, without touching the assets. Guards are cheap (a store and a fence) and can be nested.
+     *
+     * Handles (AssetHandle::get) and weak references (AssetWeak::get) resolved inside a guard stay valid until it ends, on any thread. Keep guards short: the gc can't free
+     * anything it removes while one is open.
+     */
+    class AssetReadGuard {
+      public:
+        inline AssetReadGuard() : m_Record(AssetEpoch::s_Record != nullptr ? AssetEpoch::s_Record : AssetEpoch::acquireRecord()) {
+            if (m_Record->depth++ == 0) {
+                m_Record->epoch.store(AssetEpoch::s_Epoch.load(std::memory_order::relaxed), std::memory_order::relaxed);
+                // the announcement has to be visible before anything this reads, or the gc could miss it and free what we are about to resolve
+                std::atomic_thread_fence(std::memory_order::seq_cst);
+            }
+        }
+
+        inline ~AssetReadGuard() {
+            if (--m_Record->depth == 0)
+                m_Record->epoch.store(AssetEpoch::QUIESCENT, std::memory_order::release);
+        }
+
+        AssetReadGuard(const AssetReadGuard &other)                = delete;
+        AssetReadGuard(AssetReadGuard &&other) noexcept            = delete;
+        AssetReadGuard &operator=(const AssetReadGuard &other)     = delete;
+        AssetReadGuard &operator=(AssetReadGuard &&other) noexcept = delete;
+
+      private:
+        AssetEpoch::Record *m_Record;
+    };
+
+    /**
+     * @brief Assets removed by the gc waiting for readers to move on, in lists per epoch they were retired in (oldest first).
+     *
+     * Not thread safe, the asset manager only touches it from its deletion step.
+     */
+    class AssetLimbo {
+      public:
+        /**
+         * @brief Retire an asset which can no longer be found (it's out of the registry and its slot is released)
+         */
+        void retire(AssetBase *asset);
+
+        /**
+         * @brief Free every asset retired long enough ago that no reader can still see it, advancing the epoch first if possible
+         * @return How many assets were freed
+         */
+        std::size_t reclaim();
+
+        /**
+         * @brief Free every retired asset whether or not readers could still see them. Only for when nothing can be reading (the asset manager being destroyed).
+         * @return How many assets were freed
+         */
+        std::size_t reclaimAll();
+
+        [[nodiscard]] inline bool empty() const noexcept { return m_Lists.empty(); }
+
+      private:
+        struct List {
+            AssetEpoch::epoch_t      epoch;
+            std::vector<AssetBase *> assets;
+        };
+
+        std::deque<List> m_Lists;
+
+        static std::size_t free(List &list);
+    };
+} // namespace game
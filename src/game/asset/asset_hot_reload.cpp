@@ -0,0 +1,132 @@
+//
+// Created by andy on 7/2/2025.
+//
+
+#include "asset_hot_reload.hpp"
+
+#include "game/asset/asset_manager.hpp"
+#include "game/profiler.hpp"
+#include "spdlog/spdlog.h"
+
+#include <chrono>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace game {
+#ifdef __linux__
+    // files are picked up once they are closed after writing, or renamed into place (which is how most editors save). Directories are watched as they appear.
+    static constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+    AssetHotReloader::AssetHotReloader(std::shared_ptr<AssetManager> assetManager, const std::size_t framesInFlight)
+        : m_AssetManager(std::move(assetManager)), m_FramesInFlight(framesInFlight) {
+        m_Fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_Fd < 0) {
+            spdlog::warn("Couldn't start watching for asset changes, hot reload is disabled");
+            return;
+        }
+
+        watchTree({});
+        m_WatchThread = std::jthread([this](std::stop_token stopToken) { watchThread(stopToken); });
+    }
+
+    AssetHotReloader::~AssetHotReloader() {
+        if (m_WatchThread.joinable()) {
+            m_WatchThread.request_stop();
+            m_WatchThread.join();
+        }
+        if (m_Fd >= 0)
+            close(m_Fd);
+    }
+
+    void AssetHotReloader::watchTree(const std::filesystem::path &relative) {
+        const auto directory = assetDir() / relative;
+        const int  wd        = inotify_add_watch(m_Fd, directory.c_str(), WATCH_MASK);
+        if (wd < 0) {
+            spdlog::warn("Couldn't watch '{}' for asset changes", directory.string());
+            return;
+        }
+        m_Watches[wd] = relative;
+
+        std::error_code error;
+        for (const auto &entry : std::filesystem::directory_iterator(directory, error)) {
+            if (entry.is_directory(error))
+                watchTree(relative / entry.path().filename());
+        }
+    }
+
+    void AssetHotReloader::watchThread(const std::stop_token stopToken) {
+        GAME_PROFILE_THREAD("asset hot reload");
+        alignas(inotify_event) char buffer[4096];
+        pollfd                      pfd{m_Fd, POLLIN, 0};
+
+        while (!stopToken.stop_requested()) {
+            if (::poll(&pfd, 1, 100) <= 0)
+                continue; // times out now and then to check for the stop
+
+            const auto length = read(m_Fd, buffer, sizeof(buffer));
+            for (ssize_t offset = 0; offset < length;) {
+                const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                const auto it = m_Watches.find(event->wd);
+                if (it == m_Watches.end())
+                    continue;
+                if (event->mask & IN_IGNORED) {
+                    m_Watches.erase(it); // the directory is gone
+                    continue;
+                }
+                if (event->len == 0)
+                    continue;
+
+                const auto path = it->second / event->name;
+                if (event->mask & IN_ISDIR) {
+                    watchTree(path);
+                } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                    std::lock_guard lock(m_ChangedMutex);
+                    m_Changed.insert(path.generic_string());
+                }
+            }
+        }
+    }
+#else
+    AssetHotReloader::AssetHotReloader(std::shared_ptr<AssetManager> assetManager, const std::size_t framesInFlight)
+        : m_AssetManager(std::move(assetManager)), m_FramesInFlight(framesInFlight) {
+        spdlog::warn("Asset hot reload isn't supported on this platform");
+    }
+
+    AssetHotReloader::~AssetHotReloader() = default;
+
+    void AssetHotReloader::watchTree([[maybe_unused]] const std::filesystem::path &relative) {}
+
+    void AssetHotReloader::watchThread([[maybe_unused]] std::stop_token stopToken) {}
+#endif
+
+    void AssetHotReloader::poll(const uint64_t framesSubmitted) {
+        while (!m_Retired.empty() && framesSubmitted >= m_Retired.front().frame + m_FramesInFlight) {
+            m_Retired.pop_front();
+        }
+
+        std::unordered_set<std::string> changed;
+        {
+            std::lock_guard lock(m_ChangedMutex);
+            changed.swap(m_Changed);
+        }
+
+        for (const auto &path : changed) {
+            const auto start   = std::chrono::steady_clock::now();
+            auto       retired = m_AssetManager->reloadFile(path);
+            if (retired.empty())
+                continue; // nothing loaded from it, or every reload failed
+
+            const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            spdlog::info("Hot reloaded {} asset(s) after '{}' changed in {:.2f} ms", retired.size(), path, elapsed);
+            for (auto &asset : retired) {
+                m_Retired.push_back({std::move(asset), framesSubmitted}); // the frames submitted so far might still be using the old contents
+            }
+        }
+    }
+} // namespace game
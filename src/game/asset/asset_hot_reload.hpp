@@ -0,0 +1,80 @@
+//
+// Created by andy on 7/2/2025.
+//
+
+#pragma once
+
+#include "game/asset/asset.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace game {
+    class AssetManager;
+
+    /**
+     * @brief Watches the assets directory and hot reloads assets when the files they were loaded from change.
+     *
+     * A watcher thread (inotify, so this only watches on linux) collects changed paths, and poll applies them on the render thread: each changed file is handed to
+     * AssetManager::reloadFile, which swaps the new contents into the live assets. The objects left holding the old contents are kept until the frames that might still be
+     * using them have finished on the GPU.
+     *
+     * Only loose files in the assets directory are watched, files served from an asset database or asset pack are read from there on reload too.
+     */
+    class AssetHotReloader {
+      public:
+        /**
+         * @param assetManager The manager to reload assets in
+         * @param framesInFlight How many frames can be in flight at once (old contents are destroyed once that many frames have been submitted after the reload)
+         */
+        AssetHotReloader(std::shared_ptr<AssetManager> assetManager, std::size_t framesInFlight);
+
+        /**
+         * @brief Stops watching. Old contents that haven't been destroyed yet are destroyed here, so the GPU must be idle.
+         */
+        ~AssetHotReloader();
+
+        AssetHotReloader(const AssetHotReloader &other)                = delete;
+        AssetHotReloader(AssetHotReloader &&other) noexcept            = delete;
+        AssetHotReloader &operator=(const AssetHotReloader &other)     = delete;
+        AssetHotReloader &operator=(AssetHotReloader &&other) noexcept = delete;
+
+        /**
+         * @brief Reload assets whose files changed since the last poll, and destroy old contents the GPU is done with. Call this once per frame on the render thread, outside
+         * of recording a frame.
+         * @param framesSubmitted The number of frames submitted so far (see FrameManager::framesSubmitted)
+         */
+        void poll(uint64_t framesSubmitted);
+
+      private:
+        struct Retired {
+            std::unique_ptr<AssetBase> asset;
+            uint64_t                   frame; // frames submitted when it was retired
+        };
+
+        std::shared_ptr<AssetManager> m_AssetManager;
+        std::size_t                   m_FramesInFlight;
+        std::deque<Retired>           m_Retired; // in the order they were retired, so also in frame order
+
+        std::mutex                      m_ChangedMutex;
+        std::unordered_set<std::string> m_Changed; // paths relative to the assets directory (a set, since editors tend to write a file more than once per save)
+
+        int                                            m_Fd = -1;
+        std::unordered_map<int, std::filesystem::path> m_Watches; // watch descriptor to the directory it watches (relative to the assets directory), watch thread only
+        std::jthread                                   m_WatchThread;
+
+        /**
+         * @brief Watch a directory and everything under it (inotify watches aren't recursive)
+         */
+        void watchTree(const std::filesystem::path &relative);
+
+        void watchThread(std::stop_token stopToken);
+    };
+} // namespace game
@@ -0,0 +1,128 @@
+//
+// Created by andy on 6/27/2025.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+namespace game {
+#ifdef ASSETS_64BIT_ID
+    /**
+     * @brief The type of an asset id
+     */
+    using asset_id_t = uint64_t;
+
+    /**
+     * @brief The type of the asset counter
+     */
+    using asset_counter_t = std::atomic_uint64_t;
+
+    /**
+     * @brief The type of an asset id domain
+     */
+    using asset_domain_t = uint16_t;
+
+    /**
+     * @brief The number of bits in an asset id which hold the slot index (the generation sits between the slot and the domain).
+     */
+    constexpr unsigned ASSET_SLOT_BITS = 24;
+#else
+    /**
+     * @brief The type of an asset id
+     */
+    using asset_id_t = uint32_t;
+
+    /**
+     * @brief The type of the asset counter
+     */
+    using asset_counter_t = std::atomic_uint32_t;
+
+    /**
+     * @brief The type of an asset id domain
+     */
+    using asset_domain_t = uint8_t;
+
+    /**
+     * @brief The number of bits in an asset id which hold the slot index (the generation sits between the slot and the domain).
+     */
+    constexpr unsigned ASSET_SLOT_BITS = 16;
+#endif
+
+    /**
+     * @brief The number of bits in an asset id which hold the per-domain id (the domain id occupies the remaining high bits).
+     */
+    constexpr unsigned ASSET_LOCAL_ID_BITS = (sizeof(asset_id_t) - sizeof(asset_domain_t)) * 8;
+
+    /**
+     * @brief The number of bits in an asset id which hold the slot generation.
+     */
+    constexpr unsigned ASSET_GENERATION_BITS = ASSET_LOCAL_ID_BITS - ASSET_SLOT_BITS;
+
+    /**
+     * @brief Mask for the per-domain portion of an asset id.
+     */
+    constexpr asset_id_t ASSET_LOCAL_ID_MASK = (asset_id_t{1} << ASSET_LOCAL_ID_BITS) - 1;
+
+    constexpr asset_id_t ASSET_SLOT_MASK       = (asset_id_t{1} << ASSET_SLOT_BITS) - 1;
+    constexpr asset_id_t ASSET_GENERATION_MASK = (asset_id_t{1} << ASSET_GENERATION_BITS) - 1;
+
+    /**
+     * @brief The fast id domain (ids in this domain are shared between every thread that isn't a load pool worker).
+     */
+    constexpr asset_domain_t FAST_ID_DOMAIN = 0;
+
+    /**
+     * @brief The domain for static ids (these can be hardcoded as constants).
+     */
+    constexpr asset_domain_t STATIC_DOMAIN = std::numeric_limits<asset_domain_t>::max();
+
+    constexpr asset_id_t STATIC_ID_DOMAIN = static_cast<asset_id_t>(STATIC_DOMAIN) << ASSET_LOCAL_ID_BITS;
+
+    /**
+     * @brief Build an asset id out of a domain and a per-domain id
+     * @param domain The id domain
+     * @param localId The id within the domain (must fit in ASSET_LOCAL_ID_BITS)
+     * @return The combined asset id
+     */
+    constexpr asset_id_t makeAssetId(const asset_domain_t domain, const asset_id_t localId) noexcept {
+        return (static_cast<asset_id_t>(domain) << ASSET_LOCAL_ID_BITS) | (localId & ASSET_LOCAL_ID_MASK);
+    }
+
+    /**
+     * @brief Build an asset id out of a domain, slot generation and slot index
+     */
+    constexpr asset_id_t makeAssetId(const asset_domain_t domain, const asset_id_t generation, const asset_id_t slot) noexcept {
+        return makeAssetId(domain, ((generation & ASSET_GENERATION_MASK) << ASSET_SLOT_BITS) | (slot & ASSET_SLOT_MASK));
+    }
+
+    /**
+     * @return The domain an asset id belongs to
+     */
+    constexpr asset_domain_t assetIdDomain(const asset_id_t id) noexcept {
+        return static_cast<asset_domain_t>(id >> ASSET_LOCAL_ID_BITS);
+    }
+
+    /**
+     * @return The per-domain portion of an asset id
+     */
+    constexpr asset_id_t assetLocalId(const asset_id_t id) noexcept {
+        return id & ASSET_LOCAL_ID_MASK;
+    }
+
+    /**
+     * @return The slot index an asset id refers to
+     */
+    constexpr asset_id_t assetIdSlot(const asset_id_t id) noexcept {
+        return id & ASSET_SLOT_MASK;
+    }
+
+    /**
+     * @return The generation of the slot an asset id refers to
+     */
+    constexpr asset_id_t assetIdGeneration(const asset_id_t id) noexcept {
+        return (id >> ASSET_SLOT_BITS) & ASSET_GENERATION_MASK;
+    }
+} // namespace game
@@ -0,0 +1,154 @@
+//
+// Created by andy on 6/21/2025.
+//
+
+#include "asset_load_pool.hpp"
+
+#include "game/profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+
+namespace game {
+    static thread_local AssetIdDomain *t_CurrentDomain = nullptr;
+    static thread_local AssetLoadPool *t_CurrentPool   = nullptr;
+    static std::atomic<AssetLoadPool *> s_OldestPool   = nullptr;
+
+    AssetIdDomain::AssetIdDomain(const asset_domain_t domain) : m_Domain(domain) {}
+
+    asset_id_t AssetIdDomain::next() {
+        return AssetSlotMap::allocate(m_Domain);
+    }
+
+    AssetLoadPool::AssetLoadPool(const std::size_t threadCount) {
+        AssetLoadPool *none = nullptr;
+        s_OldestPool.compare_exchange_strong(none, this);
+
+        const std::size_t count = std::clamp<std::size_t>(threadCount, 1, MAX_WORKERS);
+        m_Workers.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto domain = static_cast<asset_domain_t>(i + 1);
+            m_Workers.emplace_back([this, domain](std::stop_token stopToken) { this->workerThread(stopToken, domain); });
+        }
+    }
+
+    AssetLoadPool::~AssetLoadPool() {
+        AssetLoadPool *self = this;
+        s_OldestPool.compare_exchange_strong(self, nullptr);
+
+        for (auto &worker : m_Workers) {
+            worker.request_stop();
+        }
+        m_Workers.clear(); // joins
+
+        // anything left over never ran, so dropping it here breaks the promises of whoever was waiting on it.
+        m_Tasks.clear();
+    }
+
+    void AssetLoadPool::submit(task_t task) {
+        {
+            std::lock_guard lock(m_QueueMutex);
+            m_Tasks.push_back(std::move(task));
+        }
+        m_QueueCondition.notify_one();
+    }
+
+    bool AssetLoadPool::runPendingTask() {
+        task_t task;
+        {
+            std::lock_guard lock(m_QueueMutex);
+            if (m_Tasks.empty())
+                return false;
+            task = std::move(m_Tasks.front());
+            m_Tasks.pop_front();
+        }
+
+        task();
+        return true;
+    }
+
+    void AssetLoadPool::parallelFor(const std::size_t count, const std::function<void(std::size_t)> &body) {
+        if (count == 0)
+            return;
+
+        // shared with the helper tasks, which may only get to run after this returned (by then every index is taken, so they just drop it)
+        struct Work {
+            const std::function<void(std::size_t)> *body;
+            std::size_t                             count;
+            std::atomic_size_t                      next     = 0;
+            std::atomic_size_t                      finished = 0;
+            std::atomic_bool                        failed   = false;
+            std::mutex                              errorMutex;
+            std::exception_ptr                      error;
+
+            void run() {
+                for (std::size_t i = next.fetch_add(1, std::memory_order::relaxed); i < count; i = next.fetch_add(1, std::memory_order::relaxed)) {
+                    if (!failed.load(std::memory_order::relaxed)) {
+                        try {
+                            (*body)(i);
+                        } catch (...) {
+                            std::lock_guard lock(errorMutex);
+                            if (!error)
+                                error = std::current_exception();
+                            failed.store(true, std::memory_order::relaxed); // no point running the rest
+                        }
+                    }
+                    if (finished.fetch_add(1, std::memory_order::acq_rel) + 1 == count)
+                        finished.notify_all();
+                }
+            }
+        };
+
+        const auto work = std::make_shared<Work>(&body, count);
+        for (std::size_t i = 0, helpers = std::min(count - 1, threadCount()); i < helpers; ++i) {
+            submit([work] { work->run(); });
+        }
+        work->run();
+
+        // what's left is already being run by a worker
+        for (std::size_t finished = work->finished.load(std::memory_order::acquire); finished < count; finished = work->finished.load(std::memory_order::acquire)) {
+            work->finished.wait(finished, std::memory_order::acquire);
+        }
+
+        if (work->error)
+            std::rethrow_exception(work->error);
+    }
+
+    AssetIdDomain *AssetLoadPool::currentDomain() noexcept {
+        return t_CurrentDomain;
+    }
+
+    AssetLoadPool *AssetLoadPool::current() noexcept {
+        return t_CurrentPool ? t_CurrentPool : s_OldestPool.load(std::memory_order::acquire);
+    }
+
+    void AssetLoadPool::workerThread(std::stop_token stopToken, const asset_domain_t domain) {
+        AssetIdDomain idDomain(domain);
+        t_CurrentDomain = &idDomain;
+        t_CurrentPool   = this;
+        GAME_PROFILE_THREAD("asset loader " + std::to_string(domain));
+        DeferredAssetRefs deferredRefs;
+
+        while (!stopToken.stop_requested()) {
+            task_t task;
+            {
+                std::unique_lock lock(m_QueueMutex);
+                if (!m_QueueCondition.wait(lock, stopToken, [this] { return !m_Tasks.empty(); }))
+                    break; // stop requested
+
+                task = std::move(m_Tasks.front());
+                m_Tasks.pop_front();
+            }
+
+            GAME_PROFILE_ZONE("load pool task");
+            task();
+            deferredRefs.flush(); // the worker may sleep for a while after this, so nothing it dropped should wait on it
+        }
+
+        t_CurrentDomain = nullptr;
+        t_CurrentPool   = nullptr;
+    }
+} // namespace game
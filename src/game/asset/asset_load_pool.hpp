@@ -0,0 +1,125 @@
+//
+// Created by andy on 6/21/2025.
+//
+
+#pragma once
+
+#include "game/asset/asset.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace game {
+    /**
+     * @brief An id domain owned by a single thread.
+     *
+     * Ids are slots in the domain's part of the AssetSlotMap. Only the owning thread allocates from the domain, so its lock is only ever contended by the gc handing slots
+     * back.
+     */
+    class AssetIdDomain {
+      public:
+        explicit AssetIdDomain(asset_domain_t domain);
+
+        /**
+         * @brief Generate the next id in this domain
+         * @return A new asset id
+         * @throws std::overflow_error if the domain has run out of slots
+         */
+        asset_id_t next();
+
+        [[nodiscard]] inline asset_domain_t domain() const noexcept { return m_Domain; }
+
+      private:
+        asset_domain_t m_Domain;
+    };
+
+    /**
+     * @brief Pool of asset loading threads.
+     *
+     * Every worker owns one id domain (starting at domain 1, the fast domain is left to non-pool threads and the static domain is never handed out).
+     */
+    class AssetLoadPool {
+      public:
+        using task_t = std::move_only_function<void()>;
+
+        /**
+         * @brief The largest number of workers a pool can have (one per id domain, excluding the fast and static domains).
+         */
+        static constexpr std::size_t MAX_WORKERS = STATIC_DOMAIN - 1;
+
+        /**
+         * @param threadCount The number of worker threads to start (clamped to [1, MAX_WORKERS])
+         */
+        explicit AssetLoadPool(std::size_t threadCount);
+        ~AssetLoadPool();
+
+        AssetLoadPool(const AssetLoadPool &other)                = delete;
+        AssetLoadPool(AssetLoadPool &&other) noexcept            = delete;
+        AssetLoadPool &operator=(const AssetLoadPool &other)     = delete;
+        AssetLoadPool &operator=(AssetLoadPool &&other) noexcept = delete;
+
+        /**
+         * @brief Queue a task to be run on one of the worker threads
+         */
+        void submit(task_t task);
+
+        /**
+         * @brief Run a single queued task on the calling thread (if there is one).
+         * @return If a task was run
+         */
+        bool runPendingTask();
+
+        /**
+         * @brief Wait for a future while helping to run queued tasks.
+         *
+         * This should be used instead of future::wait by anything that might itself be running on a worker (otherwise a worker waiting on a task queued behind it would
+         * deadlock the pool).
+         */
+        template <typename T>
+        void wait(const std::future<T> &future) {
+            while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                if (!runPendingTask()) {
+                    future.wait_for(std::chrono::microseconds(100));
+                }
+            }
+        }
+
+        /**
+         * @brief Run body for every index in [0, count), on the calling thread and whichever workers are free.
+         *
+         * The calling thread works through the indices itself instead of waiting for a task to be picked up, so this can't deadlock when every worker is busy (or when
+         * it's called from a worker). It returns once every index has been handled.
+         * @throws the first exception thrown by body (the indices nobody has started yet are skipped after that)
+         */
+        void parallelFor(std::size_t count, const std::function<void(std::size_t)> &body);
+
+        [[nodiscard]] inline std::size_t threadCount() const noexcept { return m_Workers.size(); }
+
+        /**
+         * @return The id domain of the calling thread, or nullptr if the calling thread isn't a pool worker.
+         */
+        static AssetIdDomain *currentDomain() noexcept;
+
+        /**
+         * @brief The pool the calling thread should hand work to.
+         *
+         * That is the worker's own pool on a pool worker and the oldest pool still alive (the asset manager's) anywhere else. A pool must not be destroyed while another
+         * thread may still be using it through this.
+         * @return The pool, or nullptr if there isn't one
+         */
+        static AssetLoadPool *current() noexcept;
+
+      private:
+        std::mutex                  m_QueueMutex;
+        std::condition_variable_any m_QueueCondition;
+        std::deque<task_t>          m_Tasks;
+        std::vector<std::jthread>   m_Workers;
+
+        void workerThread(std::stop_token stopToken, asset_domain_t domain);
+    };
+} // namespace game
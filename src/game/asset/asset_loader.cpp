@@ -45,9 +45,8 @@ namespace game {
     }
 
     static AssetBase* loadAssetFromFileGenericInner(const std::string& path, const AssetLoaderContext& loaderContext) {
-        auto file = asset_util::openFile(path);
-        const auto& json = nlohmann::json::parse(file);
-        file.close();
+        const auto file = asset_util::readAsset(path);
+        const auto& json = asset_util::parseMetadata(file.data());
 
         const auto& type = json["type"].get<std::string>();
         
@@ -72,7 +71,7 @@ namespace game {
 
     AssetBase* loadAssetFromFileGeneric(const std::string& path, const AssetLoaderContext& loaderContext) {
         // check for metadata file
-        if (std::filesystem::exists(assetPath(path + ".json"))) {
+        if (asset_util::assetExists(path + ".json")) {
             return loadAssetFromFileGenericInner(path + ".json", loaderContext);
         }
 
@@ -1,13 +1,25 @@
 #pragma once
 
 #include "game/asset/asset.hpp"
+#include "game/asset/asset_access_trace.hpp"
+#include "game/asset/asset_database.hpp"
+#include "game/asset/asset_metadata_cache.hpp"
+#include "game/asset/asset_pack.hpp"
+#include "game/asset/asset_read_batch.hpp"
+#include "game/asset/asset_telemetry.hpp"
+#include "game/asset/compressed_asset.hpp"
+#include "game/asset/mapped_file.hpp"
+#include "game/profiler.hpp"
 #include "game/render/render_system.hpp"
 
+#include <algorithm>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
 #include <nlohmann/json.hpp>
+#include <optional>
+#include <span>
 #include <streambuf>
+#include <vector>
 
 #include <typeindex>
 
@@ -35,31 +47,159 @@ namespace game {
      * @brief Namespace containing asset utility functions which aren't meant for non-asset use
      */
     namespace asset_util {
-        static inline std::ifstream openFile(const std::filesystem::path &path) {
-            const auto fullPath = assetPath(path);
-            if (!std::filesystem::exists(fullPath)) throw std::invalid_argument("File '" + fullPath.string() + "' does not exist");
-            std::ifstream file(fullPath, std::ios::in | std::ios::binary | std::ios::ate);
-            if (file.rdstate() != std::ios_base::goodbit) {
-                throw std::invalid_argument("Couldn't open file: " + path.string());
+        /**
+         * @brief The contents of an asset file, either mapped from the assets directory, borrowed from a mounted asset pack or a read batch, or decompressed into an owned
+         * buffer.
+         *
+         * The data is only valid while this object is alive.
+         */
+        class AssetData {
+          public:
+            inline explicit AssetData(MappedFile file) : m_File(std::move(file)), m_Data(m_File->data()) {}
+
+            inline explicit AssetData(const std::span<const unsigned char> packData) : m_Data(packData) {}
+
+            inline explicit AssetData(std::vector<unsigned char> buffer) : m_Buffer(std::move(buffer)), m_Data(m_Buffer) {}
+
+            inline explicit AssetData(BatchedFile batched) : m_Batch(std::move(batched.owner)), m_Data(batched.data) {}
+
+            [[nodiscard]] inline std::span<const unsigned char> data() const noexcept { return m_Data; }
+
+            [[nodiscard]] inline std::size_t size() const noexcept { return m_Data.size(); }
+
+          private:
+            std::optional<MappedFile>              m_File;   // empty when the data lives in an asset pack, a read batch or was decompressed
+            std::vector<unsigned char>             m_Buffer; // only used for decompressed data
+            std::shared_ptr<const unsigned char[]> m_Batch;  // only used for data read by an AssetReadBatch
+            std::span<const unsigned char>         m_Data;
+        };
+
+        /**
+         * @brief Records the paths of the asset files read on the current thread while it is alive. The manager uses this to find out which files an asset was loaded from, so
+         * hot reload knows what to reload when one of them changes.
+         *
+         * Recorders nest, and an inner recorder hides its reads from the outer one. That keeps a load which runs another load on the same thread (a pool worker helping out
+         * while it waits) from picking up the other load's files.
+         */
+        class FileReadRecorder {
+          public:
+            inline FileReadRecorder() noexcept : m_Previous(s_Current) { s_Current = this; }
+
+            inline ~FileReadRecorder() { s_Current = m_Previous; }
+
+            FileReadRecorder(const FileReadRecorder &other)                = delete;
+            FileReadRecorder(FileReadRecorder &&other) noexcept            = delete;
+            FileReadRecorder &operator=(const FileReadRecorder &other)     = delete;
+            FileReadRecorder &operator=(FileReadRecorder &&other) noexcept = delete;
+
+            /**
+             * @brief Record a read with the innermost recorder on this thread (if there is one)
+             */
+            static inline void record(const std::string_view path) {
+                if (s_Current != nullptr && std::ranges::find(s_Current->m_Paths, path, &AssetName::view) == s_Current->m_Paths.end()) {
+                    s_Current->m_Paths.emplace_back(path);
+                }
             }
-            return file;
-            
+
+            /**
+             * @return The paths read so far, each once
+             */
+            [[nodiscard]] inline std::vector<AssetName> take() noexcept { return std::move(m_Paths); }
+
+          private:
+            static inline thread_local FileReadRecorder *s_Current = nullptr;
+
+            FileReadRecorder      *m_Previous;
+            std::vector<AssetName> m_Paths;
+        };
+
+        /**
+         * @brief Read an asset file without copying it. Files read by a live AssetReadBatch are served from memory, otherwise the asset database (if one is open) is consulted
+         * first, then mounted asset packs, then the assets directory.
+         *
+         * Compressed assets (see CompressedAssetHeader) are detected by their magic number and decompressed, so they can be used anywhere a raw file can.
+         *
+         * @param path The path to the asset file (relative to the assets directory)
+         * @return The contents of the asset file.
+         */
+        static inline AssetData readAsset(const std::filesystem::path &path) {
+            GAME_PROFILE_ZONE("read asset");
+            const auto start = std::chrono::steady_clock::now();
+            const auto key   = path.generic_string();
+            FileReadRecorder::record(key);
+
+            // every read is also recorded with the access trace (if one is being recorded), by the file and range it actually came from
+            const auto mapFile = [](const std::filesystem::path &file) {
+                MappedFile mapped(file);
+                recordAccess(file, 0, mapped.size());
+                return AssetData(std::move(mapped));
+            };
+            const auto borrowPacked = [](const AssetPack &pack, const std::span<const unsigned char> data) {
+                recordAccess(pack.path(), pack.offsetOf(data), data.size());
+                return AssetData(data);
+            };
+
+            auto asset = [&] {
+                if (auto batched = AssetReadBatch::find(key)) {
+                    recordAccess(batched->file, 0, batched->data.size());
+                    return AssetData(std::move(*batched));
+                }
+                if (const auto source = resolveAssetSource(key)) {
+                    if (source->pack == nullptr) {
+                        return mapFile(source->sourcePath);
+                    }
+                    if (const auto packed = source->pack->find(key)) {
+                        return borrowPacked(*source->pack, packed.value());
+                    }
+                    throw std::invalid_argument("Asset '" + key + "' is missing from the pack " + source->sourcePath.string());
+                }
+                if (const auto packed = findInAssetPacks(key)) {
+                    return borrowPacked(*packed->pack, packed->data);
+                }
+                return mapFile(assetPath(path));
+            }();
+
+            if (isCompressedAsset(asset.data())) {
+                auto decompressed = AssetData(decompressAsset(asset.data()));
+                LoadTimer::recordRead(start, asset.size());
+                return decompressed;
+            }
+            LoadTimer::recordRead(start, asset.size());
+            return asset;
+        }
+
+        /**
+         * @brief Check if an asset file exists (in the asset database, a mounted asset pack or the assets directory)
+         * @param path The path to the asset file (relative to the assets directory)
+         */
+        static inline bool assetExists(const std::filesystem::path &path) {
+            const auto key = path.generic_string();
+            return resolveAssetSource(key).has_value() || findInAssetPacks(key).has_value() || std::filesystem::exists(assetPath(path));
         }
 
         /**
          * @brief Read a file for asset loading.
          * @param path The path to the asset file (relative to the assets directory)
-         * @return The binary contents of that asset file.
+         * @return A copy of the binary contents of that asset file.
          */
         static inline std::vector<unsigned char> readFile(const std::filesystem::path &path) {
-            auto file = openFile(path);
-            const std::streamsize size = file.tellg();
-            file.seekg(0, std::ios::beg);
-            std::vector<unsigned char> buffer(size);
-            file.read(reinterpret_cast<char *>(buffer.data()), size);
-            file.close();
-
-            return buffer;
+            const auto asset = readAsset(path);
+            return {asset.data().begin(), asset.data().end()};
+        }
+
+        /**
+         * @brief Get the name an asset's json declares for itself
+         * @param json The asset (or asset metadata) json
+         * @param fallback The name to use if the json doesn't declare one (the path the asset is loaded from)
+         * @return The declared name, or the fallback
+         */
+        static inline std::string declaredName(const nlohmann::json &json, const std::string &fallback) {
+            if (json.is_object()) {
+                if (const auto it = json.find("name"); it != json.end() && it->is_string()) {
+                    return it->get<std::string>();
+                }
+            }
+            return fallback;
         }
 
     } // namespace asset_util
@@ -73,8 +213,8 @@ namespace game {
         ) const = 0;
 
         virtual AssetBase *genericLoadAssetFromFile(const std::filesystem::path &path, const O &options, const asset_id_t id, const AssetLoaderContext &loaderContext) const {
-            const auto buffer = asset_util::readFile(path);
-            return genericLoad(buffer.size(), buffer.data(), options, id, path.string(), loaderContext);
+            const auto file = asset_util::readAsset(path);
+            return genericLoad(file.size(), file.data().data(), options, id, path.string(), loaderContext);
         }
     };
 
@@ -125,8 +265,8 @@ namespace game {
          * @see AssetLoader::load
          */
         virtual T *loadAssetFromFile(const std::filesystem::path &path, const O &options, const asset_id_t id, const AssetLoaderContext &loaderContext) {
-            const auto buffer = asset_util::readFile(path);
-            return load(buffer.size(), buffer.data(), options, id, path.string(), loaderContext);
+            const auto file = asset_util::readAsset(path);
+            return load(file.size(), file.data().data(), options, id, path.string(), loaderContext);
         }
 
         /**
@@ -142,7 +282,6 @@ namespace game {
             return loadAssetFromFile(path, nullptr, id, loaderContext);
         }
 
-        // TODO: loadAssetFromCompressed and loadAssetFromPack
     };
 
     /**
@@ -168,6 +307,11 @@ namespace game {
 
         virtual ~MultiFileAssetManifest() = default;
 
+        /**
+         * @brief The name the manifest declares for the asset. If empty, the asset is named after the path it was loaded from.
+         */
+        std::optional<std::string> name;
+
         /**
          * @brief Get a list of files to load for the asset this manifest represents.
          * @return A list of path+metadata pairs which is used to actually load the asset
@@ -187,10 +331,12 @@ namespace game {
       public:
         /**
          * @brief A file entry for asset loading containing metadata extracted from the manifest and the binary contents of the file.
+         *
+         * The data is a view of the mapped file and is only valid for the duration of the load.
          */
         struct Entry {
-            D                          metadata;
-            std::vector<unsigned char> data;
+            D                              metadata;
+            std::span<const unsigned char> data;
         };
 
         T *load(
@@ -198,14 +344,17 @@ namespace game {
         ) const final {
             const M manifest = loadManifest(size, data, options, id, name, loaderContext);
 
-            const auto         fileEntries = manifest.filesToLoad();
-            std::vector<Entry> entries;
+            const auto                         fileEntries = manifest.filesToLoad();
+            std::vector<asset_util::AssetData> files; // keeps the entry data mapped until the asset is created
+            std::vector<Entry>                 entries;
+            files.reserve(fileEntries.size());
             entries.reserve(fileEntries.size());
             for (const auto &fileEntry : fileEntries) {
-                entries.push_back(Entry{fileEntry.data, asset_util::readFile(fileEntry.path)});
+                const auto &file = files.emplace_back(asset_util::readAsset(fileEntry.path));
+                entries.push_back(Entry{fileEntry.data, file.data()});
             }
 
-            return load(entries, &manifest, options, id, name, loaderContext);
+            return load(entries, &manifest, options, id, manifest.name.value_or(name), loaderContext);
         };
 
         /**
@@ -294,15 +443,15 @@ namespace game {
         /**
          * @brief Override this for asset loading logic
          *
-         * This is called by this classes implementation of the generic load function.
+         * This is called by this classes implementation of the generic load function, with the name the json declares (if it declares one).
          */
         virtual T *load(const nlohmann::json &json, const O &options, asset_id_t id, const std::string &name, const AssetLoaderContext &loaderContext) const = 0;
 
         T *load(
             const std::size_t size, const unsigned char *data, const O &options, const asset_id_t id, const std::string &name, const AssetLoaderContext &loaderContext
         ) const final {
-            const auto json = nlohmann::json::parse(data, data + size);
-            return load(json, options, id, name, loaderContext);
+            const auto json = asset_util::parseMetadata(size, data);
+            return load(json, options, id, asset_util::declaredName(json, name), loaderContext);
         }
     };
 
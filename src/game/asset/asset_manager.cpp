@@ -5,20 +5,36 @@
 #include "asset_manager.hpp"
 
 #include "game/asset/asset_bundle.hpp"
+#include "game/profiler.hpp"
 #include "game/render/pipeline_layout.hpp"
 #include "game/render/shader_object.hpp"
 #include "spdlog/spdlog.h"
 
 namespace game {
-    AssetManager::AssetManager(const std::shared_ptr<RenderSystem> &renderSystem) : m_CycleSemaphore(0), m_RenderSystem(renderSystem), m_Context{m_RenderSystem, this} {
+    static std::size_t defaultLoaderThreadCount() {
+        // leave a core for the main thread
+        const auto hardwareThreads = std::thread::hardware_concurrency();
+        return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    AssetManager::AssetManager(const std::shared_ptr<RenderSystem> &renderSystem)
+        : m_RemovalQueue(REMOVAL_QUEUE_CAPACITY), m_CycleSemaphore(0), m_RenderSystem(renderSystem), m_Context{m_RenderSystem, this}, m_LoadPool(std::make_unique<AssetLoadPool>(defaultLoaderThreadCount())),
+          m_StreamQueue(std::make_unique<AssetStreamQueue>(*this)) {
         populateLoaders();
     }
 
     AssetManager::~AssetManager() {
+        m_LoadPool.reset(); // make sure nothing is still loading while we tear down
+        m_StreamQueue.reset();
+
         m_LoadedSetMutex.lock();
         removeRecursive();
+        for (const auto &asset : m_LoadedAssets) {
+            asset->m_Manager = nullptr; // whatever is left is deleted in no particular order, so don't let it queue anything on the way out
+        }
         for (const auto &asset : m_LoadedAssets) {
             spdlog::info("Destroy: {} [{}]", asset->name(), asset->_id());
+            AssetSlotMap::release(asset->_id());
             delete asset; // because this is getting destroyed we don't need to bother with any other data structure clearing.
         }
         m_LoadedSetMutex.unlock();
@@ -37,13 +53,94 @@ namespace game {
     }
 
     GenericAssetRef AssetManager::loadFromFileUsing(const GenericAssetLoader<std::nullptr_t> *loader, const std::string &filename) {
-        if (const auto it = m_AssetsByName.find(filename); it != m_AssetsByName.end()) {
-            return it->second;
+        auto &telemetry = loaderTelemetry(loader);
+        if (auto existing = findLoaded(filename)) {
+            telemetry.cacheHits.fetch_add(1, std::memory_order::relaxed);
+            return existing;
+        }
+
+        return loadRecorded(filename, loadFunction(loader, filename), telemetry);
+    }
+
+    AssetManager::load_function_t AssetManager::loadFunction(const GenericAssetLoader<std::nullptr_t> *loader, const std::string &filename) {
+        return [this, loader, filename, &telemetry = loaderTelemetry(loader)](const asset_id_t id) {
+            GAME_PROFILE_ZONE("load asset");
+            asset_util::LoadTimer timer(telemetry);
+            auto                 *asset = loader->genericLoadAssetFromFile(filename, nullptr, id, m_Context);
+            timer.succeed();
+            return asset;
+        };
+    }
+
+    LoaderTelemetry &AssetManager::loaderTelemetry(const GenericAssetLoader<std::nullptr_t> *loader) {
+        return m_Telemetry.loader(typeid(*loader));
+    }
+
+    GenericAssetRef AssetManager::findLoaded(const AssetNameView name) const {
+        return m_Registry.visit(name, [](AssetBase *asset) { return GenericAssetRef(asset); });
+    }
+
+    void AssetManager::discardUnregistered(AssetBase *asset) noexcept {
+        AssetSlotMap::release(asset->_id());
+        delete asset;
+    }
+
+    std::future<GenericAssetRef> AssetManager::loadAsyncUsing(const std::string &loaderName, const std::string &filename) {
+        return loadAsyncUsing(getLoader(loaderName), filename);
+    }
+
+    std::future<GenericAssetRef> AssetManager::loadAsyncUsing(const GenericAssetLoader<std::nullptr_t> *loader, const std::string &filename) {
+        std::packaged_task<GenericAssetRef()> task([this, loader, filename] { return loadFromFileUsing(loader, filename); });
+        auto                                  future = task.get_future();
+        m_LoadPool->submit(std::move(task));
+        return future;
+    }
+
+    std::vector<std::unique_ptr<AssetBase>> AssetManager::reloadFile(const std::string_view path) {
+        GAME_PROFILE_ZONE("AssetManager::reloadFile");
+        // references keep the gc off the assets while we reload them. Taking them under the loaded set lock is safe since the gc holds it for the whole deletion step.
+        std::vector<std::pair<GenericAssetRef, load_function_t>> targets;
+        {
+            std::lock_guard lock(m_LoadedSetMutex);
+            for (const auto &[asset, record] : m_LoadRecords) {
+                if (std::ranges::find(record.files, path, &AssetName::view) != record.files.end()) {
+                    targets.emplace_back(asset, record.load);
+                }
+            }
         }
 
-        const auto rawAsset = loader->genericLoadAssetFromFile(filename, nullptr, generateId(), m_Context);
-        registerRawAsset(rawAsset);
-        return std::move(GenericAssetRef(rawAsset));
+        std::vector<std::unique_ptr<AssetBase>> retired;
+        for (auto &[ref, load] : targets) {
+            AssetBase *asset = ref.get();
+
+            std::unique_ptr<AssetBase>   fresh;
+            asset_util::FileReadRecorder recorder;
+            try {
+                fresh.reset(load(asset->_id())); // never registered, so sharing the live asset's id is harmless
+            } catch (const std::exception &e) {
+                spdlog::error("Failed to reload {} after '{}' changed (keeping the old version): {}", asset->name(), path, e.what());
+                continue;
+            }
+
+            if (!asset->swapContents(*fresh)) {
+                spdlog::warn("Can't reload {} in place, restart to pick up the change to '{}'", asset->name(), path);
+                continue;
+            }
+            if (fresh->name() != asset->name()) {
+                spdlog::warn("{} was renamed to {}, restart to pick up the new name", asset->name(), fresh->name());
+            }
+
+            {
+                std::lock_guard lock(m_LoadedSetMutex);
+                if (const auto it = m_LoadRecords.find(asset); it != m_LoadRecords.end()) {
+                    it->second.files = recorder.take(); // the new version might read different files
+                }
+            }
+
+            spdlog::info("Reloaded {} [{}]", asset->name(), asset->_id());
+            retired.push_back(std::move(fresh));
+        }
+        return retired;
     }
 
     GenericAssetRef AssetManager::registerAssetGeneric(AssetBase *asset) {
@@ -52,31 +149,34 @@ namespace game {
     }
 
     bool AssetManager::hasAsset(const asset_id_t id) const {
-        return m_Assets.contains(id);
+        return m_Registry.contains(id);
     }
 
-    bool AssetManager::hasAsset(const std::string &name) const {
-        return m_AssetsByName.contains(name);
+    bool AssetManager::hasAsset(const AssetNameView name) const {
+        return m_Registry.contains(name);
     }
 
     bool AssetManager::hasAsset(AssetBase *asset) const {
+        std::lock_guard lock(m_LoadedSetMutex);
         return m_LoadedAssets.contains(asset);
     }
 
     void AssetManager::queueForRemoval(const asset_id_t id) {
-        if (const auto &it = m_Assets.find(id); it != m_Assets.end()) {
-            m_RemovalQueue.enqueue(it->second);
-        }
+        m_Registry.visit(id, [this](AssetBase *asset) {
+            if (asset != nullptr)
+                queueCandidate(asset);
+        });
     }
 
-    void AssetManager::queueForRemoval(const std::string &name) {
-        if (const auto &it = m_AssetsByName.find(name); it != m_AssetsByName.end()) {
-            m_RemovalQueue.enqueue(it->second);
-        }
+    void AssetManager::queueForRemoval(const AssetNameView name) {
+        m_Registry.visit(name, [this](AssetBase *asset) {
+            if (asset != nullptr)
+                queueCandidate(asset);
+        });
     }
 
     void AssetManager::queueForRemoval(AssetBase *const asset) {
-        m_RemovalQueue.enqueue(asset);
+        queueCandidate(asset);
     }
 
     void AssetManager::startDeletionCycle() {
@@ -88,21 +188,22 @@ namespace game {
     }
 
     void AssetManager::deleteWaitingAssets() {
-        if (m_DeletionWaitingFlag.test(std::memory_order::relaxed)) {
-            std::lock_guard lock(m_LoadedSetMutex); // this will be changing during this loop
-            while (!m_RemovalQueue.empty()) {
-                auto asset = m_RemovalQueue.dequeue();
-                if (const auto &it = m_LoadedAssets.find(asset); it != m_LoadedAssets.end()) {
-                    m_Assets.erase((*it)->m_Id);
-                    m_AssetsByName.erase((*it)->m_Name);
-                    m_LoadedAssets.erase(it);
-
-                    spdlog::info("Destroy: {} [{}]", asset->name(), asset->_id());
-                    delete asset;
-                }
+        const bool waiting = m_DeletionWaitingFlag.test(std::memory_order::relaxed);
+        if (!waiting && !m_Retiring.load(std::memory_order::relaxed))
+            return;
+
+        GAME_PROFILE_ZONE("AssetManager::deleteWaitingAssets");
+        std::lock_guard         lock(m_LoadedSetMutex); // this will be changing during this loop
+        std::deque<AssetBase *> pending;
+        if (waiting) {
+            for (AssetBase *asset; m_RemovalQueue.try_dequeue(asset);) {
+                pending.push_back(asset);
             }
-            m_DeletionWaitingFlag.clear(std::memory_order::relaxed);
         }
+        collect(std::move(pending), residencyBudget());
+        m_Retiring.store(!m_Limbo.empty(), std::memory_order::relaxed);
+        if (waiting)
+            m_DeletionWaitingFlag.clear(std::memory_order::relaxed);
     }
 
     void AssetManager::endDeletionThread() {
@@ -114,28 +215,106 @@ namespace game {
         m_AssetDeletionThread.join();
     }
 
+    std::size_t AssetManager::residentBytes() const {
+        std::lock_guard lock(m_LoadedSetMutex);
+        return m_Residency.bytes();
+    }
+
     void AssetManager::removeRecursive() {
-        bool assetRemovedLastCycle;
-        do {
-            assetRemovedLastCycle = false;
-            std::deque<AssetBase *> assetsToRemove;
-            for (const auto &asset : m_LoadedAssets) {
-                if (!asset->isKeepAlive() && asset->refcount() == 0) {
-                    assetsToRemove.push_back(asset);
-                }
+        // anything already queued is picked up from the queues, everything else that is unused gets queued here. collect then follows the chains down from there.
+        std::deque<AssetBase *> pending;
+        for (AssetBase *asset; m_RemovalQueue.try_dequeue(asset);) {
+            pending.push_back(asset);
+        }
+        takeCandidates(pending);
+        for (const auto &asset : m_LoadedAssets) {
+            if (asset->isUnused()) {
+                pending.push_back(asset);
+            }
+        }
+        // nothing is kept resident, so everything cached is evicted too. Retired assets are freed without waiting for readers, so that what they release is removed too.
+        for (;;) {
+            collect(std::move(pending), 0);
+            pending.clear();
+            const DeferredAssetRefs::Suspend eager;
+            if (m_Limbo.reclaimAll() == 0)
+                break;
+            takeCandidates(pending);
+        }
+        m_Retiring.store(false, std::memory_order::relaxed);
+    }
+
+    void AssetManager::reclaim(std::deque<AssetBase *> &pending) {
+        if (m_Limbo.reclaim() > 0)
+            takeCandidates(pending);
+    }
+
+    void AssetManager::collect(std::deque<AssetBase *> pending, const std::size_t budget) {
+        // assets only reach zero references once everything referencing them is gone, so deleting in queue order (with whatever each deletion releases appended) is a
+        // topological order over the reference graph. Each asset is looked at once per time its count actually dropped to zero. Removed assets only release their references
+        // once they are freed, which waits for readers (see AssetEpoch), so a chain is collected in one step unless a reader holds it up.
+        const DeferredAssetRefs::Suspend eager; // so what freeing an asset releases is queued straight away, and collected in this step
+        for (;;) {
+            if (pending.empty()) {
+                reclaim(pending);
+                if (!pending.empty())
+                    continue;
+
+                // evict the least recently released assets until the rest fit in the budget. Whatever an eviction releases is pending again, and becomes the most recent.
+                if (m_Residency.bytes() <= budget)
+                    break;
+                if (auto *asset = m_Residency.popOldest(); asset->isUnused())
+                    destroy(asset);
+                continue;
             }
 
-            while (!assetsToRemove.empty()) {
-                assetRemovedLastCycle = true;
-                auto asset            = assetsToRemove.front();
-                assetsToRemove.pop_front();
-                m_LoadedAssets.erase(asset);
-                m_AssetsByName.erase(asset->m_Name);
-                m_Assets.erase(asset->m_Id);
-                spdlog::info("Destroy: {} [{}]", asset->name(), asset->_id());
-                delete asset;
+            auto asset = pending.front();
+            pending.pop_front();
+
+            // candidates are queued without touching the asset, so they can be duplicates of (or stale pointers to) assets that are already gone. Only assets still in
+            // the loaded set are alive, and only this function removes them from it.
+            if (!m_LoadedAssets.contains(asset))
+                continue;
+
+            if (!asset->isUnused()) {
+                m_Residency.remove(asset); // picked back up, it gets queued again when its count next drops to zero
+                continue;
+            }
+            if (budget > 0) {
+                m_Residency.touch(asset); // stays registered, so it can be revived until it is evicted
+                continue;
             }
-        } while (assetRemovedLastCycle);
+            destroy(asset);
+        }
+    }
+
+    void AssetManager::destroy(AssetBase *asset) {
+        // lookups hand out references while holding the asset's shard locks, so once the asset is out of the registry nothing new can reference it.
+        if (!m_Registry.eraseIfUnused(asset))
+            return; // picked back up, it gets queued again when its count next drops to zero
+        m_LoadedAssets.erase(asset);
+        if (const auto it = m_LoadRecords.find(asset); it != m_LoadRecords.end()) {
+            if (it->second.telemetry != nullptr)
+                it->second.telemetry->reclaimed.fetch_add(1, std::memory_order::relaxed);
+            m_LoadRecords.erase(it);
+        }
+        m_Residency.remove(asset);
+
+        spdlog::info("Destroy: {} [{}]", asset->name(), asset->_id());
+        AssetSlotMap::release(asset->_id()); // handles and weak references report expired from here on
+        m_Limbo.retire(asset);               // readers inside a guard may have resolved it just before, so it's freed once they are done (see AssetEpoch)
+        m_Retiring.store(true, std::memory_order::relaxed);
+    }
+
+    void AssetManager::queueCandidate(AssetBase *asset) {
+        std::lock_guard lock(m_CandidateMutex);
+        m_Candidates.push_back(asset);
+    }
+
+    void AssetManager::takeCandidates(std::deque<AssetBase *> &out) {
+        std::lock_guard lock(m_CandidateMutex);
+        out.insert(out.end(), m_Candidates.begin(), m_Candidates.end());
+        m_Candidates.clear();
     }
 
     void AssetManager::populateLoaders() {
@@ -143,42 +322,91 @@ namespace game {
         m_AssetLoaders["unlinked_shader"] = new UnlinkedShaderAssetLoader();
         m_AssetLoaders["pipeline_layout"] = new PipelineLayoutLoader();
         m_AssetLoaders["asset_bundle"]    = new AssetBundleLoader();
+
+        for (const auto &[name, loader] : m_AssetLoaders) {
+            m_Telemetry.nameLoader(typeid(*loader), name);
+        }
     }
 
     asset_id_t AssetManager::generateId() {
-        return m_AssetCounter.fetch_add(1, std::memory_order::relaxed); // the counter is relaxed since the actual number doesn't matter all that much, just that it's unique.
+        if (const auto domain = AssetLoadPool::currentDomain()) {
+            return domain->next();
+        }
+
+        return AssetSlotMap::allocate(FAST_ID_DOMAIN);
     }
 
     void AssetManager::registerRawAsset(AssetBase *asset) {
+        // static ids are chosen by the caller, anything else has to be a slot the slot map handed out (and nothing outside the manager can get one)
+        if (assetIdDomain(asset->m_Id) != STATIC_DOMAIN)
+            asset->m_Id = generateId();
+        AssetSlotMap::publish(asset->m_Id, asset);
+        asset->m_Manager = this;
         {
             std::lock_guard lock(m_LoadedSetMutex);
             m_LoadedAssets.insert(asset);
         }
+        m_Registry.insert(asset, [](AssetBase *) {});
+    }
 
-        m_Assets.insert({asset->_id(), asset});
-        m_AssetsByName.insert({asset->name(), asset});
+    GenericAssetRef AssetManager::loadRecorded(const std::string &filename, load_function_t load, LoaderTelemetry &telemetry) {
+        asset_util::FileReadRecorder recorder;
+        const auto                   rawAsset = withNewId([&](const asset_id_t id) { return load(id); });
+        return registerLoadedAsset(rawAsset, filename, LoadRecord{recorder.take(), std::move(load), &telemetry});
     }
 
-    // this function is the thread which queues assets to be deleted when they become unreferenced (asset gc)
+    GenericAssetRef AssetManager::registerLoadedAsset(AssetBase *asset, const std::string_view sourcePath, LoadRecord record) {
+        // both before the asset is visible to other threads
+        asset->m_Manager    = this;
+        asset->m_SourcePath = AssetName(sourcePath);
+
+        // the reference is taken while the name shards are locked, so the gc can't erase the asset before we return it
+        auto [registered, inserted] = [&] {
+            try {
+                return m_Registry.insert(asset, [asset](AssetBase *registered) { return std::pair(GenericAssetRef(registered), registered == asset); });
+            } catch (...) {
+                discardUnregistered(asset);
+                throw;
+            }
+        }();
+        if (!inserted) {
+            // another thread finished loading the same asset first, so we drop ours and hand out theirs.
+            discardUnregistered(asset);
+            return std::move(registered);
+        }
+
+        AssetSlotMap::publish(asset->_id(), asset);
+
+        std::lock_guard lock(m_LoadedSetMutex);
+        m_LoadedAssets.insert(asset);
+        m_LoadRecords.emplace(asset, std::move(record));
+        return std::move(registered);
+    }
+
+    // this function is the thread which queues assets to be deleted when they become unreferenced (asset gc). It only looks at assets whose reference count dropped to zero
+    // since the last cycle.
     void AssetManager::deletionThread(std::stop_token stopToken) {
+        GAME_PROFILE_THREAD("asset gc");
         while (!stopToken.stop_requested()) {
             m_CycleSemaphore.acquire();
             if (stopToken.stop_requested())
                 break;
 
-            {
-                bool            mark = false;
-                std::lock_guard lock(m_LoadedSetMutex);
-                for (const auto &asset : m_LoadedAssets) {
-                    if (!asset->isKeepAlive() && asset->refcount() == 0) {
-                        m_RemovalQueue.enqueue(asset);
-                        mark = true;
-                    }
-                }
+            GAME_PROFILE_ZONE("gc cycle");
+            std::deque<AssetBase *> candidates;
+            takeCandidates(candidates);
+            std::size_t queued = 0;
+            while (queued < candidates.size() && m_RemovalQueue.try_enqueue(std::move(candidates[queued]))) {
+                queued++;
+            }
+            if (queued < candidates.size()) {
+                // the removal queue is full until the next deletion step drains it, so whatever didn't fit waits for the next cycle
+                std::lock_guard lock(m_CandidateMutex);
+                m_Candidates.insert(m_Candidates.end(), candidates.begin() + static_cast<std::ptrdiff_t>(queued), candidates.end());
+            }
 
-                if (mark) {
-                    m_DeletionWaitingFlag.test_and_set(std::memory_order_relaxed);
-                }
+            if (queued > 0) {
+                m_DeletionWaitingFlag.test_and_set(std::memory_order_relaxed);
             }
         }
     }
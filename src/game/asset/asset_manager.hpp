@@ -4,9 +4,18 @@
 
 #pragma once
 #include "asset.hpp"
+#include "asset_load_pool.hpp"
 #include "asset_loader.hpp"
+#include "asset_registry.hpp"
+#include "asset_residency_cache.hpp"
+#include "asset_stream_queue.hpp"
+#include "asset_telemetry.hpp"
+#include "game/profiler.hpp"
 #include "game/utils.hpp"
 
+#include <functional>
+#include <future>
+#include <memory>
 #include <semaphore>
 #include <thread>
 #include <unordered_set>
@@ -18,7 +27,7 @@ namespace game {
     template <typename L>
     concept default_constructible_asset_loader = asset_loader<L> && std::default_initializable<L>;
 
-    // this is not a very smart loader (no threading support)
+    // loads run synchronously on the calling thread, or on the load pool through the loadAsync family (pool workers each mint ids from their own id domain).
     class AssetManager {
       public:
         explicit AssetManager(const std::shared_ptr<RenderSystem> &renderSystem);
@@ -31,13 +40,22 @@ namespace game {
 
         template <default_constructible_asset_loader T>
         AssetRef<typename T::asset_t> loadFromFile(const std::string &filename, const typename T::options_t &options) {
-            if (const auto it = m_AssetsByName.find(filename); it != m_AssetsByName.end()) {
-                return AssetRef<typename T::asset_t>(dynamic_cast<typename T::asset_t*>(it->second));
+            auto &telemetry = m_Telemetry.loader(typeid(T));
+            if (auto existing = get<typename T::asset_t>(filename)) {
+                telemetry.cacheHits.fetch_add(1, std::memory_order::relaxed);
+                return existing;
             }
 
-            T          loader{};
-            const auto rawAsset = loader.loadAssetFromFile(filename, options, generateId(), m_Context);
-            return std::move(registerAsset(rawAsset));
+            // kept with the asset, so hot reload can run the same load again
+            auto load = [this, filename, options, &telemetry](const asset_id_t id) -> AssetBase * {
+                GAME_PROFILE_ZONE("load asset");
+                asset_util::LoadTimer timer(telemetry);
+                T                     loader{};
+                auto                 *asset = loader.loadAssetFromFile(filename, options, id, m_Context);
+                timer.succeed();
+                return asset;
+            };
+            return loadRecorded(filename, std::move(load), telemetry).template as<typename T::asset_t>();
         }
 
         template <default_constructible_asset_loader T>
@@ -46,29 +64,86 @@ namespace game {
             return std::move(loadFromFile<T>(filename, nullptr));
         }
 
+        /**
+         * @brief Load an asset on the load pool
+         * @param filename The path to the asset (relative to the assets directory)
+         * @param options The load options
+         * @return A future which is ready once the asset is loaded and registered
+         */
+        template <default_constructible_asset_loader T>
+        std::future<AssetRef<typename T::asset_t>> loadAsync(const std::string &filename, const typename T::options_t &options) {
+            std::packaged_task<AssetRef<typename T::asset_t>()> task([this, filename, options] { return loadFromFile<T>(filename, options); });
+            auto                                                future = task.get_future();
+            m_LoadPool->submit(std::move(task));
+            return future;
+        }
+
+        template <default_constructible_asset_loader T>
+            requires(std::same_as<typename T::options_t, std::nullptr_t>)
+        std::future<AssetRef<typename T::asset_t>> loadAsync(const std::string &filename) {
+            return loadAsync<T>(filename, nullptr);
+        }
+
+        std::future<GenericAssetRef> loadAsyncUsing(const std::string &loaderName, const std::string &filename);
+        std::future<GenericAssetRef> loadAsyncUsing(const GenericAssetLoader<std::nullptr_t> *loader, const std::string &filename);
+
+        [[nodiscard]] inline AssetLoadPool &loadPool() const noexcept { return *m_LoadPool; }
+
+        /**
+         * @brief The queue for streaming assets in with a per-frame budget (see AssetStreamQueue)
+         */
+        [[nodiscard]] inline AssetStreamQueue &streamQueue() const noexcept { return *m_StreamQueue; }
+
         const GenericAssetLoader<std::nullptr_t> *getLoader(const std::string &loaderName) const;
         GenericAssetRef                           loadFromFileUsing(const std::string &loaderName, const std::string &filename);
         GenericAssetRef                           loadFromFileUsing(const GenericAssetLoader<std::nullptr_t> *loader, const std::string &filename);
 
+        /**
+         * @brief Reload every asset which read a file when it was loaded, swapping the new contents into the live assets (see AssetBase::swapContents)
+         *
+         * Call this from the thread that uses asset contents (the render thread), between uses. An asset whose reload fails or whose type can't swap keeps its old contents,
+         * and the failure is logged.
+         *
+         * @param path The path of the changed file (relative to the assets directory)
+         * @return The objects now holding the old contents. They aren't registered with anything, so the caller decides when it is safe to destroy them (once the GPU is done
+         * with them, for render assets).
+         */
+        std::vector<std::unique_ptr<AssetBase>> reloadFile(std::string_view path);
+
+        /**
+         * @brief Per-loader counters and latencies for every load made through this manager (see AssetTelemetry)
+         */
+        [[nodiscard]] inline const AssetTelemetry &telemetry() const noexcept { return m_Telemetry; }
+
+        /**
+         * @brief Register an asset built outside of a loader, which takes ownership of it.
+         *
+         * An asset with a static id keeps it. Any other asset is given a freshly allocated id (what it was constructed with is ignored, since ids outside the static domain
+         * can only come from the slot map), so use the asset's handle after this rather than the id it was built with.
+         * @return A reference to the registered asset
+         */
         template <asset_type T>
         AssetRef<T> registerAsset(T *asset) {
             registerRawAsset(asset);
             return std::move(AssetRef<T>(asset));
         }
 
+        /**
+         * @brief Register an asset built outside of a loader (see registerAsset)
+         */
         GenericAssetRef registerAssetGeneric(AssetBase *asset);
 
         [[nodiscard]] bool hasAsset(asset_id_t id) const;
-        [[nodiscard]] bool hasAsset(const std::string &name) const;
+        [[nodiscard]] bool hasAsset(AssetNameView name) const;
         [[nodiscard]] bool hasAsset(AssetBase *asset) const;
 
         template <asset_type T>
         [[nodiscard]] bool hasAsset(const AssetHandle<T> &asset) const {
-            return hasAsset(asset.id);
+            return !asset.expired();
         };
 
         void queueForRemoval(asset_id_t id);
-        void queueForRemoval(const std::string &name);
+        void queueForRemoval(AssetNameView name);
         void queueForRemoval(AssetBase *asset);
 
         template <asset_type T>
@@ -76,54 +151,156 @@ namespace game {
             queueForRemoval(asset.id);
         };
 
+        /**
+         * @brief Set how many bytes of unreferenced assets (see AssetBase::footprint) to keep resident. Assets are only deleted once they are unreferenced and the least
+         * recently released assets don't fit in the budget anymore, and looking up or loading a resident asset again revives it. 0 (the default) deletes unreferenced assets
+         * straight away.
+         *
+         * A smaller budget takes effect at the next deletion step.
+         */
+        inline void setResidencyBudget(const std::size_t bytes) noexcept { m_ResidencyBudget.store(bytes, std::memory_order::relaxed); }
+
+        [[nodiscard]] inline std::size_t residencyBudget() const noexcept { return m_ResidencyBudget.load(std::memory_order::relaxed); }
+
+        /**
+         * @return The bytes charged for unreferenced assets kept resident (an upper bound, see AssetResidencyCache)
+         */
+        [[nodiscard]] std::size_t residentBytes() const;
+
         void startDeletionCycle();
         void beginDeletionThread();
+
+        /**
+         * @brief The deletion step: removes the assets the gc queued that are still unused, and frees removed assets once no AssetReadGuard can still see them
+         */
         void deleteWaitingAssets();
         void endDeletionThread();
         void finalEndDeletionThread();
+
+        /**
+         * @brief Remove every unused asset and everything only they kept alive, freeing them straight away. Nothing may be reading assets on other threads while this runs
+         * (the destructor uses it).
+         */
         void removeRecursive();
 
         void populateLoaders();
 
-        template <typename T>
-        AssetRef<T> get(const std::string &name) const {
-            if (const auto it = m_AssetsByName.find(name); it != m_AssetsByName.end()) {
-                return AssetRef<T>(dynamic_cast<T *>(it->second));
-            }
-            return AssetRef<T>();
+        // get and hasAsset are safe to call from any thread. Names can be an asset's declared name or the path it was loaded from.
+
+        template <asset_type T>
+        AssetRef<T> get(const AssetNameView name) const {
+            return m_Registry.visit(name, [](AssetBase *asset) { return AssetRef<T>(assetCast<T>(asset)); });
         }
 
-        template <typename T>
+        template <asset_type T>
         AssetRef<T> get(const asset_id_t id) const {
-            if (const auto it = m_Assets.find(id); it != m_Assets.end()) {
-                return AssetRef<T>(dynamic_cast<T *>(it->second));
-            }
-            return AssetRef<T>();
+            return m_Registry.visit(id, [](AssetBase *asset) { return AssetRef<T>(assetCast<T>(asset)); });
         }
 
       protected:
-        asset_id_t generateId();
-        void       registerRawAsset(AssetBase *asset);
+        asset_id_t      generateId();
+
+        /**
+         * @brief Run a load with a freshly generated id, giving the id back if the load throws
+         */
+        template <typename F>
+        decltype(auto) withNewId(F &&load) {
+            const auto id = generateId();
+            try {
+                return std::forward<F>(load)(id);
+            } catch (...) {
+                AssetSlotMap::release(id);
+                throw;
+            }
+        }
+
+        /**
+         * @brief Publish and register an asset, allocating its id unless it has a static id
+         */
+        void registerRawAsset(AssetBase *asset);
+
+        using load_function_t = std::function<AssetBase *(asset_id_t)>;
+
+        /**
+         * @return A function loading a file with a generic loader (timed with the loader's telemetry)
+         */
+        load_function_t loadFunction(const GenericAssetLoader<std::nullptr_t> *loader, const std::string &filename);
+
+        /**
+         * @return The telemetry of a generic loader
+         */
+        LoaderTelemetry &loaderTelemetry(const GenericAssetLoader<std::nullptr_t> *loader);
+
+        /**
+         * @return The asset loaded from a path (or with that name), or an empty reference
+         */
+        GenericAssetRef findLoaded(AssetNameView name) const;
+
+        /**
+         * @brief Give back the id of a loaded asset that will never be registered, and delete it
+         */
+        static void discardUnregistered(AssetBase *asset) noexcept;
+
+        /**
+         * @brief How an asset was loaded from files, kept so it can be hot reloaded.
+         */
+        struct LoadRecord {
+            std::vector<AssetName> files; // every file the load read (the file it was loaded from first)
+            load_function_t        load;
+            LoaderTelemetry       *telemetry = nullptr; // of the loader that loaded it
+        };
+
+        /**
+         * @brief Load an asset from a file with a new id, recording the files it reads, and register it
+         */
+        GenericAssetRef loadRecorded(const std::string &filename, load_function_t load, LoaderTelemetry &telemetry);
+
+        /**
+         * @brief Register an asset loaded from a file, indexing it under both its name and the path it was loaded from
+         * @return The registered asset, which is another thread's copy if that thread finished loading the same path first
+         */
+        GenericAssetRef registerLoadedAsset(AssetBase *asset, std::string_view sourcePath, LoadRecord record);
 
       private:
-        std::unordered_map<asset_id_t, AssetBase *>  m_Assets;
-        std::unordered_map<std::string, AssetBase *> m_AssetsByName;
-        std::unordered_set<AssetBase *>              m_LoadedAssets;
-        asset_counter_t                              m_AssetCounter = 1;
+        friend class AssetBase;
+        friend class AssetStreamQueue;
+
+        AssetRegistry                               m_Registry;
+        std::unordered_set<AssetBase *>             m_LoadedAssets;
+        std::unordered_map<AssetBase *, LoadRecord> m_LoadRecords; // guarded by m_LoadedSetMutex like m_LoadedAssets, only has assets loaded from files
 
         std::unordered_map<std::string, GenericAssetLoader<std::nullptr_t> *> m_AssetLoaders;
+        AssetTelemetry                                                        m_Telemetry;
+
+        static constexpr std::size_t REMOVAL_QUEUE_CAPACITY = 4096;
+
+        bounded_mpmc_queue<AssetBase *> m_RemovalQueue; // these assets are queued for removal next time the system runs its deletion step
 
-        concurrent_queue<AssetBase *> m_RemovalQueue; // these assets are queued for removal next time the system
+        std::mutex               m_CandidateMutex;
+        std::vector<AssetBase *> m_Candidates; // assets whose reference count dropped to zero (or lost keep alive) since the last cycle
 
-        std::mutex            m_LoadedSetMutex;
+        std::atomic<std::size_t> m_ResidencyBudget = 0;
+        AssetResidencyCache      m_Residency;        // guarded by m_LoadedSetMutex
+        AssetLimbo               m_Limbo;            // removed assets waiting for readers to move on (see AssetEpoch), guarded by m_LoadedSetMutex
+        std::atomic<bool>        m_Retiring = false; // if the limbo has anything in it, so deletion steps with nothing else to do can skip the lock
+
+        mutable std::mutex    m_LoadedSetMutex;
         std::jthread          m_AssetDeletionThread;
         std::binary_semaphore m_CycleSemaphore;
         std::atomic_flag      m_DeletionWaitingFlag;
 
-        std::shared_ptr<RenderSystem> m_RenderSystem;
-        AssetLoaderContext            m_Context;
+        std::shared_ptr<RenderSystem>     m_RenderSystem;
+        AssetLoaderContext                m_Context;
+        std::unique_ptr<AssetLoadPool>    m_LoadPool;
+        std::unique_ptr<AssetStreamQueue> m_StreamQueue;
 
         void deletionThread(std::stop_token);
+
+        void queueCandidate(AssetBase *asset);
+        void takeCandidates(std::deque<AssetBase *> &out);
+        void collect(std::deque<AssetBase *> pending, std::size_t budget); // m_LoadedSetMutex must be held
+        void destroy(AssetBase *asset);                                    // m_LoadedSetMutex must be held
+        void reclaim(std::deque<AssetBase *> &pending);                    // m_LoadedSetMutex must be held, frees what readers are done with and queues what it released
     };
 
 } // namespace game
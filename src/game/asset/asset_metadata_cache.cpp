@@ -0,0 +1,220 @@
+//
+// Created by andy on 7/1/2025.
+//
+
+#include "asset_metadata_cache.hpp"
+
+#include "game/asset/asset_telemetry.hpp"
+#include "game/profiler.hpp"
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <shared_mutex>
+#include <stdexcept>
+
+namespace game {
+    AssetMetadataCache::AssetMetadataCache(const std::filesystem::path &path) : m_Path(path) {
+        if (!std::filesystem::exists(path))
+            return;
+
+        const auto ignore = [&](const std::string &reason) {
+            spdlog::warn("Ignoring metadata cache '{}': {}", path.string(), reason);
+            m_File.reset();
+        };
+
+        try {
+            m_File.emplace(path);
+        } catch (const std::exception &e) {
+            ignore(e.what());
+            return;
+        }
+
+        const auto data = m_File->data();
+        if (data.size() < sizeof(MetadataCacheHeader)) {
+            ignore("file is too small");
+            return;
+        }
+
+        const auto &h = *reinterpret_cast<const MetadataCacheHeader *>(data.data());
+        if (h.magic != MetadataCacheHeader::MAGIC) {
+            ignore("bad magic");
+            return;
+        }
+        if (h.version != MetadataCacheHeader::VERSION) {
+            ignore("unsupported version " + std::to_string(h.version));
+            return;
+        }
+        if ((data.size() - sizeof(MetadataCacheHeader)) / sizeof(MetadataCacheEntry) < h.entryCount) {
+            ignore("table is out of bounds");
+            return;
+        }
+
+        const auto *entries = reinterpret_cast<const MetadataCacheEntry *>(data.data() + sizeof(MetadataCacheHeader));
+        for (std::size_t i = 0; i < h.entryCount; i++) {
+            const auto &entry = entries[i];
+            if (entry.dataOffset > data.size() || entry.contentSize > data.size() - entry.dataOffset ||
+                data.size() - entry.dataOffset - entry.contentSize < entry.dataSize) {
+                ignore("entry data is out of bounds");
+                return;
+            }
+            if (i > 0 && entries[i - 1].contentHash > entry.contentHash) {
+                ignore("table isn't sorted");
+                return;
+            }
+        }
+        m_Entries = {entries, static_cast<std::size_t>(h.entryCount)};
+        m_Used    = std::make_unique<std::atomic_bool[]>(m_Entries.size());
+    }
+
+    uint64_t AssetMetadataCache::contentHash(const std::span<const unsigned char> text) noexcept {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (const unsigned char c : text) {
+            hash ^= c;
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    std::optional<nlohmann::json> AssetMetadataCache::find(const std::span<const unsigned char> text) const {
+        const Key key{contentHash(text), text.size()};
+        if (const auto *entry = findEntry(key, text)) {
+            m_Used[entry - m_Entries.data()].store(true, std::memory_order::relaxed);
+            const auto *cbor = m_File->data().data() + entry->dataOffset + entry->contentSize;
+            return nlohmann::json::from_cbor(cbor, cbor + entry->dataSize);
+        }
+
+        std::lock_guard lock(m_AddedMutex);
+        if (const auto it = m_Added.find(key); it != m_Added.end() && std::ranges::equal(it->second.text, text)) {
+            return nlohmann::json::from_cbor(it->second.cbor);
+        }
+        return std::nullopt;
+    }
+
+    void AssetMetadataCache::put(const std::span<const unsigned char> text, const nlohmann::json &json) {
+        const Key key{contentHash(text), text.size()};
+        if (const auto *entry = findEntry(key, text)) {
+            m_Used[entry - m_Entries.data()].store(true, std::memory_order::relaxed);
+            return;
+        }
+
+        Added           added{{text.begin(), text.end()}, nlohmann::json::to_cbor(json)};
+        std::lock_guard lock(m_AddedMutex);
+        m_Added.try_emplace(key, std::move(added)); // if different text with the same key got here first, this one just isn't cached
+    }
+
+    void AssetMetadataCache::save() {
+        std::lock_guard lock(m_AddedMutex);
+        if (m_Added.empty())
+            return;
+
+        // a run may not load every asset, so what it didn't look up is only dropped once it has gone unused for a few saves
+        struct Pending {
+            Key                            key;
+            std::span<const unsigned char> text;
+            std::span<const unsigned char> cbor;
+            uint32_t                       unusedSaves;
+        };
+        std::vector<Pending> pending;
+        pending.reserve(m_Entries.size() + m_Added.size());
+        for (std::size_t i = 0; i < m_Entries.size(); i++) {
+            const auto    &entry       = m_Entries[i];
+            const uint32_t unusedSaves = m_Used[i].load(std::memory_order::relaxed) ? 0 : entry.unusedSaves + 1;
+            if (unusedSaves <= MAX_UNUSED_SAVES)
+                pending.push_back({{entry.contentHash, entry.contentSize},
+                                   m_File->data().subspan(entry.dataOffset, entry.contentSize),
+                                   m_File->data().subspan(entry.dataOffset + entry.contentSize, entry.dataSize),
+                                   unusedSaves});
+        }
+        for (const auto &[key, added] : m_Added) {
+            pending.push_back({key, added.text, added.cbor, 0});
+        }
+        std::ranges::sort(pending, {}, [](const Pending &p) { return p.key.hash; });
+
+        const MetadataCacheHeader       header{MetadataCacheHeader::MAGIC, MetadataCacheHeader::VERSION, pending.size()};
+        std::vector<MetadataCacheEntry> table;
+        table.reserve(pending.size());
+        uint64_t offset = sizeof(MetadataCacheHeader) + pending.size() * sizeof(MetadataCacheEntry);
+        for (const auto &p : pending) {
+            table.push_back({p.key.hash, p.key.size, offset, p.cbor.size(), p.unusedSaves, 0});
+            offset += p.text.size() + p.cbor.size();
+        }
+
+        auto temp = m_Path;
+        temp += ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char *>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(MetadataCacheEntry)));
+            for (const auto &p : pending) {
+                out.write(reinterpret_cast<const char *>(p.text.data()), static_cast<std::streamsize>(p.text.size()));
+                out.write(reinterpret_cast<const char *>(p.cbor.data()), static_cast<std::streamsize>(p.cbor.size()));
+            }
+            if (!out)
+                throw std::runtime_error("Failed to write metadata cache '" + temp.string() + "'");
+        }
+        std::filesystem::rename(temp, m_Path); // the old file stays mapped until we drop it below
+
+        spdlog::info("Saved {} entries to metadata cache '{}' ({} dropped as unused)", pending.size(), m_Path.string(), m_Entries.size() + m_Added.size() - pending.size());
+        m_Added.clear();
+        m_Entries = {};
+        m_File.emplace(m_Path);
+        m_Entries = {reinterpret_cast<const MetadataCacheEntry *>(m_File->data().data() + sizeof(MetadataCacheHeader)), pending.size()};
+        m_Used    = std::make_unique<std::atomic_bool[]>(m_Entries.size()); // a save starts a new period, so nothing counts as used yet
+    }
+
+    const MetadataCacheEntry *AssetMetadataCache::findEntry(const Key &key, const std::span<const unsigned char> text) const noexcept {
+        auto it = std::ranges::lower_bound(m_Entries, key.hash, {}, &MetadataCacheEntry::contentHash);
+        for (; it != m_Entries.end() && it->contentHash == key.hash; ++it) {
+            // the hash only narrows it down, the text has to match too
+            if (it->contentSize == key.size && std::ranges::equal(m_File->data().subspan(it->dataOffset, it->contentSize), text))
+                return &*it;
+        }
+        return nullptr;
+    }
+
+    static std::shared_mutex                   s_CacheMutex;
+    static std::unique_ptr<AssetMetadataCache> s_Cache;
+
+    void openMetadataCache(const std::filesystem::path &path) {
+        auto            cache = std::make_unique<AssetMetadataCache>(path);
+        std::lock_guard lock(s_CacheMutex);
+        s_Cache = std::move(cache);
+    }
+
+    void saveMetadataCache() {
+        std::lock_guard lock(s_CacheMutex); // exclusive, since saving remaps the file out from under any lookups
+        if (s_Cache == nullptr)
+            return;
+
+        try {
+            s_Cache->save();
+        } catch (const std::exception &e) {
+            spdlog::warn("Couldn't save the metadata cache: {}", e.what()); // it's only a cache, the next launch parses the text again
+        }
+    }
+
+    namespace asset_util {
+        nlohmann::json parseMetadata(const std::span<const unsigned char> text) {
+            GAME_PROFILE_ZONE("parse metadata");
+            const auto       start = std::chrono::steady_clock::now();
+            std::shared_lock lock(s_CacheMutex);
+            if (s_Cache == nullptr) {
+                auto json = nlohmann::json::parse(text.begin(), text.end());
+                LoadTimer::recordParse(start, false);
+                return json;
+            }
+
+            if (auto cached = s_Cache->find(text)) {
+                LoadTimer::recordParse(start, true);
+                return std::move(*cached);
+            }
+            auto json = nlohmann::json::parse(text.begin(), text.end());
+            s_Cache->put(text, json);
+            LoadTimer::recordParse(start, false);
+            return json;
+        }
+    } // namespace asset_util
+} // namespace game
@@ -0,0 +1,154 @@
+//
+// Created by andy on 7/1/2025.
+//
+
+#pragma once
+
+#include "game/asset/mapped_file.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace game {
+    /**
+     * @brief On-disk header of the metadata cache (all values little-endian).
+     */
+    struct MetadataCacheHeader {
+        static constexpr uint32_t MAGIC   = 0x434D4754; // "TGMC"
+        static constexpr uint32_t VERSION = 3;
+
+        uint32_t magic;
+        uint32_t version;
+        uint64_t entryCount;
+    };
+
+    static_assert(sizeof(MetadataCacheHeader) == 16);
+
+    /**
+     * @brief An entry in the metadata cache's table, which follows the header and is sorted by contentHash.
+     */
+    struct MetadataCacheEntry {
+        uint64_t contentHash; // of the json text
+        uint64_t contentSize; // of the json text
+        uint64_t dataOffset;  // of a copy of the json text followed by its CBOR, from the start of the file
+        uint64_t dataSize;    // of the CBOR
+        uint32_t unusedSaves; // saves in a row this entry wasn't looked up before, see AssetMetadataCache::MAX_UNUSED_SAVES
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(MetadataCacheEntry) == 40);
+
+    /**
+     * @brief A cache of parsed json metadata, stored as CBOR and keyed by a hash of the json text.
+     *
+     * Every entry keeps a copy of its json text, which a lookup compares against before trusting the entry, so a hash collision is a miss rather than the wrong metadata.
+     *
+     * The cache file is mapped when it is opened and looked up with a binary search, so a hit costs a hash of the text and a CBOR decode instead of a text parse. Misses are
+     * parsed as text and remembered, and save() writes them out alongside what was already cached. An entry which hasn't been looked up for MAX_UNUSED_SAVES
+     * saves is dropped, so stale entries (e.g. of json that was edited) don't pile up. The cache is disposable: a missing, stale or corrupt file is just ignored
+     * (and replaced on the next save).
+     *
+     * find and put may be called from any thread.
+     */
+    class AssetMetadataCache {
+      public:
+        /**
+         * @brief How many saves an entry can go without being looked up before it's dropped.
+         *
+         * Entries aren't dropped as soon as a run doesn't use them, since a run may just not get to some of the assets.
+         */
+        static constexpr uint32_t MAX_UNUSED_SAVES = 4;
+
+        /**
+         * @param path The full path to the cache file (it doesn't have to exist yet)
+         */
+        explicit AssetMetadataCache(const std::filesystem::path &path);
+
+        AssetMetadataCache(const AssetMetadataCache &other)                = delete;
+        AssetMetadataCache(AssetMetadataCache &&other) noexcept            = delete;
+        AssetMetadataCache &operator=(const AssetMetadataCache &other)     = delete;
+        AssetMetadataCache &operator=(AssetMetadataCache &&other) noexcept = delete;
+
+        /**
+         * @return The hash the cache keys json text by (64-bit FNV-1a)
+         */
+        static uint64_t contentHash(std::span<const unsigned char> text) noexcept;
+
+        /**
+         * @brief Look up the parsed form of some json text
+         * @return The parsed json, or an empty optional if the text isn't cached
+         */
+        [[nodiscard]] std::optional<nlohmann::json> find(std::span<const unsigned char> text) const;
+
+        /**
+         * @brief Remember the parsed form of some json text (written out by the next save)
+         */
+        void put(std::span<const unsigned char> text, const nlohmann::json &json);
+
+        /**
+         * @brief Write the cache file if anything was added since it was opened. The file is written next to the old one and renamed over it.
+         *
+         * The new file has everything added, every entry which was looked up since the file was opened and the entries which haven't gone unused for too long.
+         * @throws std::runtime_error if the file can't be written
+         */
+        void save();
+
+      private:
+        struct Key {
+            uint64_t hash;
+            uint64_t size;
+
+            bool operator==(const Key &) const = default;
+        };
+
+        struct KeyHash {
+            inline std::size_t operator()(const Key &key) const noexcept { return static_cast<std::size_t>(key.hash ^ key.size); }
+        };
+
+        std::filesystem::path               m_Path;
+        std::optional<MappedFile>           m_File;
+        std::span<const MetadataCacheEntry> m_Entries; // points into m_File
+        std::unique_ptr<std::atomic_bool[]> m_Used;    // for each of m_Entries, if it was looked up since the file was opened
+
+        struct Added {
+            std::vector<unsigned char> text;
+            std::vector<std::uint8_t>  cbor;
+        };
+
+        mutable std::mutex                      m_AddedMutex;
+        std::unordered_map<Key, Added, KeyHash> m_Added; // everything parsed since the file was opened
+
+        [[nodiscard]] const MetadataCacheEntry *findEntry(const Key &key, std::span<const unsigned char> text) const noexcept;
+    };
+
+    /**
+     * @brief Open the metadata cache used by asset_util::parseMetadata (replacing any cache which is already open)
+     */
+    void openMetadataCache(const std::filesystem::path &path);
+
+    /**
+     * @brief Save the open metadata cache, if there is one (see AssetMetadataCache::save). Failures are logged rather than thrown.
+     */
+    void saveMetadataCache();
+
+    namespace asset_util {
+        /**
+         * @brief Parse json asset metadata, going through the metadata cache if one is open
+         * @param text The json text
+         * @return The parsed json
+         */
+        nlohmann::json parseMetadata(std::span<const unsigned char> text);
+
+        inline nlohmann::json parseMetadata(const std::size_t size, const unsigned char *data) {
+            return parseMetadata(std::span(data, size));
+        }
+    } // namespace asset_util
+} // namespace game
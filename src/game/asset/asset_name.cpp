@@ -0,0 +1,63 @@
+//
+// Created by andy on 6/28/2025.
+//
+
+#include "asset_name.hpp"
+
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace game {
+    namespace {
+        struct ViewHash {
+            inline std::size_t operator()(const AssetNameView &name) const noexcept { return name.hash(); }
+        };
+
+        struct ViewEqual {
+            inline bool operator()(const AssetNameView &lhs, const AssetNameView &rhs) const noexcept { return lhs.view() == rhs.view(); }
+        };
+
+        template <typename Entry>
+        struct StringTable {
+            std::shared_mutex                                                     mutex;
+            std::unordered_map<AssetNameView, const Entry *, ViewHash, ViewEqual> entries; // the keys view the entry's own string
+        };
+
+        template <typename Entry>
+        StringTable<Entry> &stringTable() {
+            static auto *table = new StringTable<Entry>(); // never destroyed, assets (and their names) can outlive static destruction order
+            return *table;
+        }
+    } // namespace
+
+    AssetName::AssetName(const std::string_view name) {
+        if (name.empty())
+            return;
+
+        auto               &table = stringTable<Entry>();
+        const AssetNameView key(name);
+        {
+            std::shared_lock lock(table.mutex);
+            if (const auto it = table.entries.find(key); it != table.entries.end()) {
+                m_Entry = it->second;
+                return;
+            }
+        }
+
+        std::lock_guard lock(table.mutex);
+        if (const auto it = table.entries.find(key); it != table.entries.end()) {
+            m_Entry = it->second; // interned by someone else in between
+            return;
+        }
+        const auto *entry = new Entry{std::string(name), key.hash()};
+        table.entries.emplace(AssetNameView(std::string_view(entry->value)), entry);
+        m_Entry = entry;
+    }
+
+    std::size_t AssetName::internedCount() {
+        auto            &table = stringTable<Entry>();
+        std::shared_lock lock(table.mutex);
+        return table.entries.size();
+    }
+} // namespace game
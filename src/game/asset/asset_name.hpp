@@ -0,0 +1,116 @@
+//
+// Created by andy on 6/28/2025.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace game {
+    /**
+     * @brief Hash used for asset names (64-bit FNV-1a, truncated to size_t).
+     */
+    constexpr std::size_t assetNameHash(const std::string_view name) noexcept {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (const char c : name) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 0x100000001b3ULL;
+        }
+        return static_cast<std::size_t>(hash);
+    }
+
+    class AssetNameView;
+
+    /**
+     * @brief An interned asset name (or asset path).
+     *
+     * Every distinct string is stored once in a global string table along with its hash, and an AssetName is just a pointer to that entry. Copying a name is a pointer copy,
+     * comparing two names is a pointer compare and hashing one reads the stored hash. Interned strings are never freed, which is fine for asset names since there is a bounded
+     * number of them (and it means views of a name stay valid for the life of the program).
+     */
+    class AssetName {
+      public:
+        /**
+         * @brief The empty name
+         */
+        AssetName() noexcept = default;
+
+        /**
+         * @brief Intern a string (takes the string table's lock, so don't do this on a hot path, keep the name instead)
+         */
+        explicit AssetName(std::string_view name);
+
+        [[nodiscard]] inline std::string_view view() const noexcept { return m_Entry != nullptr ? std::string_view(m_Entry->value) : std::string_view(); }
+
+        [[nodiscard]] inline const char *c_str() const noexcept { return m_Entry != nullptr ? m_Entry->value.c_str() : ""; }
+
+        [[nodiscard]] inline std::size_t hash() const noexcept { return m_Entry != nullptr ? m_Entry->hash : EMPTY_HASH; }
+
+        [[nodiscard]] inline bool empty() const noexcept { return m_Entry == nullptr; }
+
+        inline operator std::string_view() const noexcept { return view(); } // NOLINT(*-explicit-constructor)
+
+        inline bool operator==(const AssetName &rhs) const noexcept { return m_Entry == rhs.m_Entry; }
+
+        bool operator==(const AssetNameView &rhs) const noexcept;
+
+        /**
+         * @return The number of distinct strings in the string table
+         */
+        static std::size_t internedCount();
+
+      private:
+        struct Entry {
+            std::string value;
+            std::size_t hash;
+        };
+
+        static constexpr std::size_t EMPTY_HASH = assetNameHash({});
+
+        const Entry *m_Entry = nullptr; // nullptr is the empty name (so the empty string is never interned)
+    };
+
+    /**
+     * @brief A name to look an asset up with, hashed once up front. This is the heterogeneous lookup key for maps keyed by AssetName, so looking a name up never interns it.
+     */
+    class AssetNameView {
+      public:
+        inline AssetNameView(const std::string_view name) noexcept : m_Value(name), m_Hash(assetNameHash(name)) {} // NOLINT(*-explicit-constructor)
+
+        inline AssetNameView(const std::string &name) noexcept : AssetNameView(std::string_view(name)) {} // NOLINT(*-explicit-constructor)
+
+        inline AssetNameView(const char *name) noexcept : AssetNameView(std::string_view(name)) {} // NOLINT(*-explicit-constructor)
+
+        inline AssetNameView(const AssetName &name) noexcept : m_Value(name.view()), m_Hash(name.hash()) {} // NOLINT(*-explicit-constructor)
+
+        [[nodiscard]] inline std::string_view view() const noexcept { return m_Value; }
+
+        [[nodiscard]] inline std::size_t hash() const noexcept { return m_Hash; }
+
+      private:
+        std::string_view m_Value;
+        std::size_t      m_Hash;
+    };
+
+    inline bool AssetName::operator==(const AssetNameView &rhs) const noexcept {
+        return hash() == rhs.hash() && view() == rhs.view();
+    }
+
+    /**
+     * @brief Transparent hash for containers keyed by AssetName (lookups can use an AssetNameView, or anything that converts to one)
+     */
+    struct AssetNameHash {
+        using is_transparent = void;
+
+        inline std::size_t operator()(const AssetName &name) const noexcept { return name.hash(); }
+
+        inline std::size_t operator()(const AssetNameView &name) const noexcept { return name.hash(); }
+    };
+} // namespace game
+
+template <>
+struct std::hash<game::AssetName> {
+    inline std::size_t operator()(const game::AssetName &name) const noexcept { return name.hash(); }
+};
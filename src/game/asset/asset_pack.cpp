@@ -0,0 +1,88 @@
+//
+// Created by andy on 6/23/2025.
+//
+
+#include "asset_pack.hpp"
+
+#include <memory>
+#include <shared_mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace game {
+    AssetPack::AssetPack(const std::filesystem::path &path) : m_Path(path), m_File(path) {
+        const auto invalid = [&](const std::string &reason) { return std::invalid_argument("Invalid asset pack '" + path.string() + "': " + reason); };
+
+        if (m_File.size() < sizeof(AssetPackHeader))
+            throw invalid("file is too small");
+
+        const auto &h = header();
+        if (h.magic != AssetPackHeader::MAGIC)
+            throw invalid("bad magic");
+        if (h.version != AssetPackHeader::VERSION)
+            throw invalid("unsupported version " + std::to_string(h.version));
+        if (h.bucketCount == 0 || (h.bucketCount & (h.bucketCount - 1)) != 0 || h.entryCount >= h.bucketCount)
+            throw invalid("table of contents must have a power of two number of buckets, with at least one empty bucket");
+        if (h.tocOffset % alignof(AssetPackTocEntry) != 0 || h.tocOffset > m_File.size() || m_File.size() - h.tocOffset < h.bucketCount * sizeof(AssetPackTocEntry))
+            throw invalid("table of contents is out of bounds");
+        if (h.stringsOffset > m_File.size())
+            throw invalid("string table is out of bounds");
+    }
+
+    std::optional<std::span<const unsigned char>> AssetPack::find(const std::string_view path) const noexcept {
+        const auto hash    = assetPackHash(path);
+        const auto entries = toc();
+        const auto mask    = entries.size() - 1;
+        const auto base    = m_File.data();
+
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+            const auto &entry = entries[i];
+            if (entry.pathHash == 0)
+                return std::nullopt;
+            if (entry.pathHash != hash)
+                continue;
+
+            // bounds are checked here rather than up front so opening a pack doesn't have to touch every page of the table
+            const auto strings = base.subspan(header().stringsOffset);
+            if (entry.pathOffset > strings.size() || strings.size() - entry.pathOffset < entry.pathLength)
+                return std::nullopt;
+            if (std::string_view(reinterpret_cast<const char *>(strings.data() + entry.pathOffset), entry.pathLength) != path)
+                continue;
+
+            if (entry.dataOffset > base.size() || base.size() - entry.dataOffset < entry.dataSize)
+                return std::nullopt;
+            return base.subspan(entry.dataOffset, entry.dataSize);
+        }
+    }
+
+    static std::shared_mutex                        s_PacksMutex;
+    static std::vector<std::unique_ptr<AssetPack>> s_Packs;
+
+    const AssetPack &mountAssetPack(const std::filesystem::path &path) {
+        {
+            std::shared_lock lock(s_PacksMutex);
+            for (const auto &pack : s_Packs) {
+                if (pack->path() == path)
+                    return *pack;
+            }
+        }
+
+        auto            pack = std::make_unique<AssetPack>(path);
+        std::lock_guard lock(s_PacksMutex);
+        for (const auto &mounted : s_Packs) {
+            if (mounted->path() == path)
+                return *mounted;
+        }
+        return *s_Packs.emplace_back(std::move(pack));
+    }
+
+    std::optional<PackedAsset> findInAssetPacks(const std::string_view path) {
+        std::shared_lock lock(s_PacksMutex);
+        for (auto it = s_Packs.rbegin(); it != s_Packs.rend(); ++it) {
+            if (const auto data = (*it)->find(path)) {
+                return PackedAsset{it->get(), data.value()};
+            }
+        }
+        return std::nullopt;
+    }
+} // namespace game
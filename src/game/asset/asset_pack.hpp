@@ -0,0 +1,123 @@
+//
+// Created by andy on 6/23/2025.
+//
+
+#pragma once
+
+#include "game/asset/mapped_file.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace game {
+    /**
+     * @brief Hash used for asset pack lookups (64-bit FNV-1a over the asset path).
+     *
+     * Paths are relative to the assets directory with forward slashes. 0 is reserved to mark empty table slots, so it is remapped to 1.
+     */
+    constexpr uint64_t assetPackHash(const std::string_view path) noexcept {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (const char c : path) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 0x100000001b3ULL;
+        }
+        return hash == 0 ? 1 : hash;
+    }
+
+    /**
+     * @brief On-disk header of an asset pack (all values little-endian).
+     */
+    struct AssetPackHeader {
+        static constexpr uint32_t MAGIC   = 0x50414754; // "TGAP"
+        static constexpr uint32_t VERSION = 1;
+
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t bucketCount; // power of two
+        uint64_t tocOffset;
+        uint64_t stringsOffset;
+    };
+
+    static_assert(sizeof(AssetPackHeader) == 32);
+
+    /**
+     * @brief A slot in the pack's table of contents. The table is an open-addressed (linear probing) hash table of bucketCount slots, empty slots have a pathHash of 0.
+     */
+    struct AssetPackTocEntry {
+        uint64_t pathHash;
+        uint64_t dataOffset; // from the start of the pack, aligned to ASSET_PACK_DATA_ALIGNMENT
+        uint64_t dataSize;
+        uint32_t pathOffset; // from the start of the string table
+        uint32_t pathLength;
+    };
+
+    static_assert(sizeof(AssetPackTocEntry) == 32);
+
+    constexpr std::size_t ASSET_PACK_DATA_ALIGNMENT = 16;
+
+    /**
+     * @brief A single-file asset pack.
+     *
+     * The whole pack is mapped once when it is opened, and lookups are a hash and a (usually single) table probe. Data returned from the pack is valid for as long as the pack
+     * is alive.
+     */
+    class AssetPack {
+      public:
+        /**
+         * @param path The full path to the pack file
+         */
+        explicit AssetPack(const std::filesystem::path &path);
+
+        /**
+         * @brief Find an asset in the pack
+         * @param path The path of the asset relative to the assets directory
+         * @return The asset's data, or nullopt if the pack doesn't contain it
+         */
+        [[nodiscard]] std::optional<std::span<const unsigned char>> find(std::string_view path) const noexcept;
+
+        /**
+         * @param data Data returned by find
+         * @return Where the data starts in the pack file
+         */
+        [[nodiscard]] inline uint64_t offsetOf(const std::span<const unsigned char> data) const noexcept { return static_cast<uint64_t>(data.data() - m_File.data().data()); }
+
+        [[nodiscard]] inline uint32_t entryCount() const noexcept { return header().entryCount; }
+
+        [[nodiscard]] inline const std::filesystem::path &path() const noexcept { return m_Path; }
+
+      private:
+        std::filesystem::path m_Path;
+        MappedFile            m_File;
+
+        [[nodiscard]] inline const AssetPackHeader &header() const noexcept { return *reinterpret_cast<const AssetPackHeader *>(m_File.data().data()); }
+
+        [[nodiscard]] inline std::span<const AssetPackTocEntry> toc() const noexcept {
+            return {reinterpret_cast<const AssetPackTocEntry *>(m_File.data().data() + header().tocOffset), header().bucketCount};
+        }
+    };
+
+    /**
+     * @brief Mount an asset pack. Mounted packs are searched (most recently mounted first) before the assets directory whenever an asset file is read.
+     * @param path The full path to the pack file
+     * @return The mounted pack (if a pack with the same path is already mounted, that pack is returned instead of mapping it again)
+     */
+    const AssetPack &mountAssetPack(const std::filesystem::path &path);
+
+    /**
+     * @brief An asset found in a mounted pack
+     */
+    struct PackedAsset {
+        const AssetPack               *pack;
+        std::span<const unsigned char> data; // valid for the lifetime of the program, packs are never unmounted
+    };
+
+    /**
+     * @brief Find an asset in the mounted packs
+     * @param path The path of the asset relative to the assets directory
+     * @return The asset and the pack it was found in, or nullopt if no mounted pack contains it
+     */
+    std::optional<PackedAsset> findInAssetPacks(std::string_view path);
+} // namespace game
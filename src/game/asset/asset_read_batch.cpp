@@ -0,0 +1,358 @@
+//
+// Created by andy on 7/5/2025.
+//
+
+#include "asset_read_batch.hpp"
+
+#include "game/asset/asset_loader.hpp"
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <shared_mutex>
+#include <system_error>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace game {
+    namespace asset_util {
+        static std::shared_mutex                             s_BatchedMutex;
+        static std::unordered_map<std::string, BatchedFile>  s_Batched;
+        static std::atomic<std::size_t>                      s_BatchCount = 0; // live batches, so reads outside of a batch don't have to take the lock
+        static std::vector<std::shared_ptr<unsigned char[]>> s_Abandoned;      // buffers of batches that failed with reads still in flight
+
+#ifdef __linux__
+        namespace {
+            /**
+             * @brief The minimal part of io_uring the batch needs: a submission and completion ring and one registered buffer.
+             */
+            class IoUring {
+              public:
+                explicit IoUring(const unsigned entries) {
+                    try {
+                        setup(entries);
+                    } catch (...) {
+                        release();
+                        throw;
+                    }
+                }
+
+                ~IoUring() { release(); }
+
+                IoUring(const IoUring &other)            = delete;
+                IoUring &operator=(const IoUring &other) = delete;
+
+                /**
+                 * @return If the buffer was registered (registering can fail, for example when it is larger than the memlock limit)
+                 */
+                bool registerBuffer(void *data, const std::size_t size) noexcept {
+                    iovec iov{data, size};
+                    return syscall(__NR_io_uring_register, m_Fd, IORING_REGISTER_BUFFERS, &iov, 1) == 0;
+                }
+
+                /**
+                 * @return A zeroed submission entry, or nullptr if the submission ring is full
+                 */
+                io_uring_sqe *nextSqe() noexcept {
+                    const unsigned head = std::atomic_ref(*m_SqHead).load(std::memory_order_acquire);
+                    if (m_SqLocalTail - head >= m_Entries)
+                        return nullptr;
+
+                    const unsigned index = m_SqLocalTail & m_SqMask;
+                    m_SqArray[index]     = index;
+                    m_SqLocalTail++;
+                    std::memset(&m_Sqes[index], 0, sizeof(io_uring_sqe));
+                    return &m_Sqes[index];
+                }
+
+                /**
+                 * @brief Submit the entries queued since the last submit, and wait for at least one completion
+                 */
+                void submitAndWait() {
+                    const unsigned submit = m_SqLocalTail - *m_SqTail;
+                    std::atomic_ref(*m_SqTail).store(m_SqLocalTail, std::memory_order_release);
+                    while (syscall(__NR_io_uring_enter, m_Fd, submit, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0) {
+                        if (errno != EINTR)
+                            throw std::system_error(errno, std::generic_category(), "io_uring_enter");
+                    }
+                }
+
+                /**
+                 * @brief Hand every available completion to fn
+                 */
+                template <typename F> void drain(F &&fn) {
+                    unsigned       head = *m_CqHead;
+                    const unsigned tail = std::atomic_ref(*m_CqTail).load(std::memory_order_acquire);
+                    for (; head != tail; head++) {
+                        fn(m_Cqes[head & m_CqMask]);
+                    }
+                    std::atomic_ref(*m_CqHead).store(head, std::memory_order_release);
+                }
+
+              private:
+                int           m_Fd   = -1;
+                void         *m_Sq   = nullptr;
+                void         *m_Cq   = nullptr;
+                io_uring_sqe *m_Sqes = nullptr;
+                std::size_t   m_SqSize = 0, m_CqSize = 0, m_SqesSize = 0;
+
+                unsigned *m_SqHead = nullptr, *m_SqTail = nullptr, *m_SqArray = nullptr;
+                unsigned  m_SqMask = 0, m_Entries = 0, m_SqLocalTail = 0;
+
+                unsigned     *m_CqHead = nullptr, *m_CqTail = nullptr;
+                unsigned      m_CqMask = 0;
+                io_uring_cqe *m_Cqes   = nullptr;
+
+                void setup(const unsigned entries) {
+                    io_uring_params params{};
+                    m_Fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+                    if (m_Fd < 0)
+                        throw std::system_error(errno, std::generic_category(), "io_uring_setup");
+                    // the batch never has more reads in flight than submission entries, so a completion ring at least that big can't overflow (the kernel makes it twice as big)
+                    if (params.cq_entries < entries)
+                        throw std::system_error(EINVAL, std::generic_category(), "io_uring completion ring is smaller than the queue depth");
+
+                    m_SqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                    m_CqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                    if (params.features & IORING_FEAT_SINGLE_MMAP)
+                        m_SqSize = m_CqSize = std::max(m_SqSize, m_CqSize);
+
+                    m_Sq = mmap(nullptr, m_SqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_Fd, IORING_OFF_SQ_RING);
+                    if (m_Sq == MAP_FAILED) {
+                        m_Sq = nullptr;
+                        throw std::system_error(errno, std::generic_category(), "mapping the submission ring");
+                    }
+                    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+                        m_Cq = m_Sq;
+                    } else {
+                        m_Cq = mmap(nullptr, m_CqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_Fd, IORING_OFF_CQ_RING);
+                        if (m_Cq == MAP_FAILED) {
+                            m_Cq = nullptr;
+                            throw std::system_error(errno, std::generic_category(), "mapping the completion ring");
+                        }
+                    }
+                    m_SqesSize = params.sq_entries * sizeof(io_uring_sqe);
+                    void *sqes = mmap(nullptr, m_SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_Fd, IORING_OFF_SQES);
+                    if (sqes == MAP_FAILED)
+                        throw std::system_error(errno, std::generic_category(), "mapping the submission entries");
+                    m_Sqes = static_cast<io_uring_sqe *>(sqes);
+
+                    auto *sq  = static_cast<unsigned char *>(m_Sq);
+                    m_SqHead  = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+                    m_SqTail  = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+                    m_SqMask  = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+                    m_SqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+                    m_Entries = params.sq_entries;
+
+                    auto *cq = static_cast<unsigned char *>(m_Cq);
+                    m_CqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+                    m_CqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+                    m_CqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+                    m_Cqes   = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+                }
+
+                void release() noexcept {
+                    if (m_Sqes != nullptr)
+                        munmap(m_Sqes, m_SqesSize);
+                    if (m_Cq != nullptr && m_Cq != m_Sq)
+                        munmap(m_Cq, m_CqSize);
+                    if (m_Sq != nullptr)
+                        munmap(m_Sq, m_SqSize);
+                    if (m_Fd >= 0)
+                        close(m_Fd); // also unregisters the buffer
+                }
+            };
+
+            constexpr unsigned    BATCH_QUEUE_DEPTH = 64;
+            constexpr std::size_t BATCH_CHUNK_SIZE  = 256 * 1024; // large files are split into reads of this size, so they can be read in parallel too
+            constexpr std::size_t BATCH_ALIGNMENT   = 16;
+
+            struct BatchFile {
+                std::string           path;
+                std::filesystem::path file;
+                int                   fd;
+                std::size_t           offset; // in the batch's buffer
+                std::size_t           size;
+                bool                  failed = false;
+            };
+
+            struct BatchRead {
+                std::size_t file;
+                uint64_t    offset; // in the file
+                std::size_t length;
+            };
+        } // namespace
+
+        AssetReadBatch::AssetReadBatch(const std::span<const std::string> paths) {
+            std::vector<BatchFile> files;
+            std::size_t            total = 0;
+            for (const auto &path : paths) {
+                // only loose files need reading, packs are already mapped (this follows readAsset's order of sources)
+                std::filesystem::path file;
+                if (const auto source = resolveAssetSource(path)) {
+                    if (source->pack != nullptr)
+                        continue;
+                    file = source->sourcePath;
+                } else if (findInAssetPacks(path)) {
+                    continue;
+                } else {
+                    file = assetPath(path);
+                }
+
+                const int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0)
+                    continue; // readAsset reports the error
+                struct stat st{};
+                if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+                    close(fd);
+                    continue;
+                }
+
+                const auto size = static_cast<std::size_t>(st.st_size);
+                files.push_back({path, std::move(file), fd, total, size});
+                total += (size + BATCH_ALIGNMENT - 1) / BATCH_ALIGNMENT * BATCH_ALIGNMENT;
+            }
+
+            const auto closeFiles = [&] {
+                for (const auto &file : files) {
+                    close(file.fd);
+                }
+            };
+            if (files.empty())
+                return;
+
+            std::optional<IoUring> ring;
+            try {
+                ring.emplace(BATCH_QUEUE_DEPTH);
+            } catch (const std::system_error &e) {
+                spdlog::debug("Not batching asset reads, io_uring is unavailable: {}", e.what());
+                closeFiles();
+                return;
+            }
+
+            m_Buffer             = std::make_shared_for_overwrite<unsigned char[]>(std::max<std::size_t>(total, 1));
+            const bool registered = ring->registerBuffer(m_Buffer.get(), std::max<std::size_t>(total, 1));
+
+            std::deque<BatchRead> queued;
+            for (std::size_t i = 0; i < files.size(); i++) {
+                for (std::size_t offset = 0; offset < files[i].size; offset += BATCH_CHUNK_SIZE) {
+                    queued.push_back({i, offset, std::min(BATCH_CHUNK_SIZE, files[i].size - offset)});
+                }
+            }
+
+            std::vector<BatchRead> inFlight; // indexed by user_data, slots are reused once they complete
+            std::vector<std::size_t> freeSlots;
+            std::size_t              outstanding = 0;
+            try {
+                while (!queued.empty() || outstanding > 0) {
+                    // every submit empties the submission ring, so the ring alone doesn't bound what's in flight
+                    while (!queued.empty() && outstanding < BATCH_QUEUE_DEPTH) {
+                        io_uring_sqe *sqe = ring->nextSqe();
+                        if (sqe == nullptr)
+                            break;
+
+                        const auto read = queued.front();
+                        queued.pop_front();
+                        std::size_t slot;
+                        if (freeSlots.empty()) {
+                            slot = inFlight.size();
+                            inFlight.push_back(read);
+                        } else {
+                            slot = freeSlots.back();
+                            freeSlots.pop_back();
+                            inFlight[slot] = read;
+                        }
+
+                        const auto &file = files[read.file];
+                        sqe->opcode      = registered ? IORING_OP_READ_FIXED : IORING_OP_READ;
+                        sqe->fd          = file.fd;
+                        sqe->off         = read.offset;
+                        sqe->addr        = reinterpret_cast<uint64_t>(m_Buffer.get() + file.offset + read.offset);
+                        sqe->len         = static_cast<uint32_t>(read.length);
+                        sqe->buf_index   = 0;
+                        sqe->user_data   = slot;
+                        outstanding++;
+                    }
+
+                    ring->submitAndWait();
+                    ring->drain([&](const io_uring_cqe &cqe) {
+                        const auto slot = static_cast<std::size_t>(cqe.user_data);
+                        auto       read = inFlight[slot];
+                        freeSlots.push_back(slot);
+                        outstanding--;
+
+                        if (cqe.res == -EAGAIN || cqe.res == -EINTR) {
+                            queued.push_back(read);
+                        } else if (cqe.res <= 0) {
+                            files[read.file].failed = true; // an error, or the file shrank under us
+                        } else if (static_cast<std::size_t>(cqe.res) < read.length) {
+                            read.offset += cqe.res; // short read, queue the rest
+                            read.length -= cqe.res;
+                            queued.push_back(read);
+                        }
+                    });
+                }
+            } catch (const std::system_error &e) {
+                spdlog::warn("Batched asset read failed, falling back to reading files one at a time: {}", e.what());
+                ring.reset();
+                closeFiles();
+                if (outstanding > 0) {
+                    // the kernel can still be writing into the buffer after the ring is closed, so it is never freed
+                    std::lock_guard lock(s_BatchedMutex);
+                    s_Abandoned.push_back(std::move(m_Buffer));
+                }
+                m_Buffer.reset();
+                return;
+            }
+            ring.reset();
+            closeFiles();
+
+            std::lock_guard lock(s_BatchedMutex);
+            for (auto &file : files) {
+                if (file.failed)
+                    continue;
+                s_Batched.insert_or_assign(file.path, BatchedFile{m_Buffer, {m_Buffer.get() + file.offset, file.size}, std::move(file.file)});
+                m_Paths.push_back(std::move(file.path));
+            }
+            s_BatchCount.fetch_add(1, std::memory_order_release);
+        }
+#else
+        AssetReadBatch::AssetReadBatch(std::span<const std::string>) {} // nothing is batched, readAsset reads every file itself
+#endif
+
+        AssetReadBatch::~AssetReadBatch() {
+            if (m_Buffer == nullptr)
+                return;
+
+            std::lock_guard lock(s_BatchedMutex);
+            for (const auto &path : m_Paths) {
+                // a newer batch may have read the same file since
+                if (const auto it = s_Batched.find(path); it != s_Batched.end() && it->second.owner == m_Buffer)
+                    s_Batched.erase(it);
+            }
+            s_BatchCount.fetch_sub(1, std::memory_order_release);
+        }
+
+        std::optional<BatchedFile> AssetReadBatch::find(const std::string &path) {
+            if (s_BatchCount.load(std::memory_order_acquire) == 0)
+                return std::nullopt;
+
+            std::shared_lock lock(s_BatchedMutex);
+            if (const auto it = s_Batched.find(path); it != s_Batched.end())
+                return it->second;
+            return std::nullopt;
+        }
+    } // namespace asset_util
+} // namespace game
@@ -0,0 +1,68 @@
+//
+// Created by andy on 7/5/2025.
+//
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace game {
+    namespace asset_util {
+        /**
+         * @brief A file read ahead of time by an AssetReadBatch.
+         */
+        struct BatchedFile {
+            std::shared_ptr<const unsigned char[]> owner; // keeps the batch's buffer alive
+            std::span<const unsigned char>         data;
+            std::filesystem::path                  file; // the full path it was read from
+        };
+
+        /**
+         * @brief Reads a set of asset files up front in one batch, so the loads that follow find their data already in memory instead of each waiting on its own read.
+         *
+         * On linux the reads are submitted together through io_uring into a single registered buffer (large files are split into several reads), so a big batch is limited by
+         * queue depth rather than by syscalls. While the batch is alive, readAsset serves its files from memory. Data handed out stays valid after the batch is destroyed.
+         *
+         * Batching is only an optimization: files in asset packs are already mapped and are skipped, files that can't be read are left to readAsset (which reports the error as
+         * usual), and where io_uring isn't available nothing is batched at all and every file is read the normal way.
+         */
+        class AssetReadBatch {
+          public:
+            /**
+             * @param paths The asset files to read (relative to the assets directory)
+             */
+            explicit AssetReadBatch(std::span<const std::string> paths);
+
+            /**
+             * @brief Stops serving the batch's files (data already handed out stays valid)
+             */
+            ~AssetReadBatch();
+
+            AssetReadBatch(const AssetReadBatch &other)                = delete;
+            AssetReadBatch(AssetReadBatch &&other) noexcept            = delete;
+            AssetReadBatch &operator=(const AssetReadBatch &other)     = delete;
+            AssetReadBatch &operator=(AssetReadBatch &&other) noexcept = delete;
+
+            /**
+             * @return The number of files read by the batch
+             */
+            [[nodiscard]] inline std::size_t size() const noexcept { return m_Paths.size(); }
+
+            /**
+             * @brief Find a file read by a batch which is still alive
+             * @param path The path to the asset file (relative to the assets directory, using /)
+             * @return The file, or nullopt if no live batch read it
+             */
+            static std::optional<BatchedFile> find(const std::string &path);
+
+          private:
+            std::shared_ptr<unsigned char[]> m_Buffer;
+            std::vector<std::string>         m_Paths; // the files served from m_Buffer
+        };
+    } // namespace asset_util
+} // namespace game
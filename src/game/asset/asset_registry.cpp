@@ -0,0 +1,95 @@
+//
+// Created by andy on 6/26/2025.
+//
+
+#include "asset_registry.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace game {
+    bool AssetRegistry::contains(const asset_id_t id) const {
+        const auto      &shard = idShard(id);
+        std::shared_lock lock(shard.mutex);
+        return shard.map.contains(id);
+    }
+
+    bool AssetRegistry::contains(const AssetNameView name) const {
+        const auto      &shard = nameShard(name.hash());
+        std::shared_lock lock(shard.mutex);
+        return shard.map.contains(name);
+    }
+
+    bool AssetRegistry::eraseIfUnused(const AssetBase *asset) {
+        const auto      aliases = aliasesOf(*asset);
+        const auto      locks   = lockNames(aliases);
+        auto           &ids     = idShard(asset->m_Id);
+        std::lock_guard idLock(ids.mutex);
+        if (asset->isKeepAlive() || asset->refcount() != 0)
+            return false; // picked back up since it was queued
+
+        eraseNames(aliases, asset);
+        if (const auto it = ids.map.find(asset->m_Id); it != ids.map.end() && it->second == asset) {
+            ids.map.erase(it);
+        }
+        return true;
+    }
+
+    void AssetRegistry::erase(const AssetBase *asset) {
+        const auto      aliases = aliasesOf(*asset);
+        const auto      locks   = lockNames(aliases);
+        auto           &ids     = idShard(asset->m_Id);
+        std::lock_guard idLock(ids.mutex);
+        eraseNames(aliases, asset);
+        if (const auto it = ids.map.find(asset->m_Id); it != ids.map.end() && it->second == asset) {
+            ids.map.erase(it);
+        }
+    }
+
+    AssetRegistry::Aliases AssetRegistry::aliasesOf(const AssetBase &asset) noexcept {
+        // the source path decides whether two loads are the same asset, the declared name is just another way to find it
+        if (asset.m_SourcePath.empty())
+            return {asset.m_Name, {}};
+        if (asset.m_Name == asset.m_SourcePath)
+            return {asset.m_SourcePath, {}};
+        return {asset.m_SourcePath, asset.m_Name};
+    }
+
+    AssetRegistry::NameLocks AssetRegistry::lockNames(const Aliases &aliases) {
+        auto first = shardIndex(aliases.primary.hash());
+        if (aliases.secondary.empty())
+            return {std::unique_lock(m_ByName[first].mutex), {}};
+
+        auto second = shardIndex(aliases.secondary.hash());
+        if (first == second)
+            return {std::unique_lock(m_ByName[first].mutex), {}};
+        if (second < first)
+            std::swap(first, second);
+
+        NameLocks locks;
+        locks.first  = std::unique_lock(m_ByName[first].mutex);
+        locks.second = std::unique_lock(m_ByName[second].mutex);
+        return locks;
+    }
+
+    void AssetRegistry::eraseNames(const Aliases &aliases, const AssetBase *asset) {
+        for (const auto &alias : {aliases.primary, aliases.secondary}) {
+            if (alias.empty())
+                continue;
+
+            auto &names = nameShard(alias.hash());
+            if (const auto it = names.map.find(alias); it != names.map.end() && it->second == asset) {
+                names.map.erase(it);
+            }
+        }
+    }
+
+    void AssetRegistry::checkAliasFree(const AssetName &alias) const {
+        const auto &names = nameShard(alias.hash());
+        if (const auto it = names.map.find(alias); it != names.map.end()) {
+            throw std::invalid_argument(
+                "Asset name '" + std::string(alias.view()) + "' is already used by another asset (loaded from '" + std::string(it->second->sourcePath()) + "')"
+            );
+        }
+    }
+} // namespace game
@@ -0,0 +1,154 @@
+//
+// Created by andy on 6/26/2025.
+//
+
+#pragma once
+
+#include "game/asset/asset.hpp"
+
+#include <array>
+#include <bit>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace game {
+    /**
+     * @brief The asset manager's id and name indices.
+     *
+     * Both indices are split into shards, each behind its own reader/writer lock, so lookups only ever contend with writers that hash to the same shard. Lookups hand the asset to
+     * a callback while the shard is still locked, which lets callers take a reference before the asset can be erased (erasure rechecks the refcount under the same locks).
+     *
+     * The name index holds every alias of an asset: its name and, for loaded assets, the path it was loaded from. Keys are interned names with their hash stored alongside, so
+     * lookups (by AssetNameView) hash the string once and never allocate.
+     *
+     * Lock order: name shards are locked before the id shard, in ascending shard order when an asset's aliases land in different shards. No more than one id shard is held at a
+     * time.
+     */
+    class AssetRegistry {
+      public:
+        static constexpr std::size_t SHARD_COUNT = 64;
+
+        /**
+         * @brief Look an asset up by id
+         * @param f Called with the asset (or nullptr if there isn't one) while the shard is locked
+         * @return Whatever f returns
+         */
+        template <typename F>
+        decltype(auto) visit(const asset_id_t id, F &&f) const {
+            const auto      &shard = idShard(id);
+            std::shared_lock lock(shard.mutex);
+            const auto       it = shard.map.find(id);
+            return std::forward<F>(f)(it != shard.map.end() ? it->second : nullptr);
+        }
+
+        /**
+         * @brief Look an asset up by name or source path
+         * @param f Called with the asset (or nullptr if there isn't one) while the shard is locked
+         * @return Whatever f returns
+         */
+        template <typename F>
+        decltype(auto) visit(const AssetNameView name, F &&f) const {
+            const auto      &shard = nameShard(name.hash());
+            std::shared_lock lock(shard.mutex);
+            const auto       it = shard.map.find(name);
+            return std::forward<F>(f)(it != shard.map.end() ? it->second : nullptr);
+        }
+
+        [[nodiscard]] bool contains(asset_id_t id) const;
+        [[nodiscard]] bool contains(AssetNameView name) const;
+
+        /**
+         * @brief Add an asset to both indices under all of its aliases, unless its primary alias (the source path, or the name if it has no source path) is already registered
+         * @param f Called with the registered asset (the existing one if the primary alias was taken) while the name shards are still locked
+         * @return Whatever f returns
+         * @throws std::invalid_argument if the primary alias is free but another alias belongs to a different asset (two sources declaring the same name)
+         */
+        template <typename F>
+        decltype(auto) insert(AssetBase *asset, F &&f) {
+            const auto aliases = aliasesOf(*asset);
+            const auto locks   = lockNames(aliases);
+            auto      &primary = nameShard(aliases.primary.hash());
+            if (const auto it = primary.map.find(aliases.primary); it != primary.map.end()) {
+                return std::forward<F>(f)(it->second);
+            }
+            if (!aliases.secondary.empty()) {
+                checkAliasFree(aliases.secondary);
+            }
+
+            primary.map.emplace(aliases.primary, asset);
+            if (!aliases.secondary.empty()) {
+                nameShard(aliases.secondary.hash()).map.emplace(aliases.secondary, asset);
+            }
+            {
+                auto           &ids = idShard(asset->m_Id);
+                std::lock_guard idLock(ids.mutex);
+                ids.map.emplace(asset->m_Id, asset);
+            }
+            return std::forward<F>(f)(asset);
+        }
+
+        /**
+         * @brief Remove an asset from both indices, but only if it is unreferenced and not kept alive (checked while all of its shards are locked, so no lookup can pick it up
+         * in between)
+         * @return If the asset was removed
+         */
+        bool eraseIfUnused(const AssetBase *asset);
+
+        /**
+         * @brief Remove an asset from both indices unconditionally
+         */
+        void erase(const AssetBase *asset);
+
+      private:
+        template <typename M>
+        struct alignas(64) Shard { // keep shards on separate cache lines so readers of neighbouring shards don't bounce each other's lock
+            mutable std::shared_mutex mutex;
+            M                         map;
+        };
+
+        using id_shard_t   = Shard<std::unordered_map<asset_id_t, AssetBase *>>;
+        using name_shard_t = Shard<std::unordered_map<AssetName, AssetBase *, AssetNameHash, std::equal_to<>>>;
+
+        /**
+         * @brief The names an asset is indexed under (the secondary alias is empty if the asset only has one)
+         */
+        struct Aliases {
+            AssetName primary;
+            AssetName secondary;
+        };
+
+        /**
+         * @brief The locked name shards for an asset's aliases
+         */
+        struct NameLocks {
+            std::unique_lock<std::shared_mutex> first;
+            std::unique_lock<std::shared_mutex> second;
+        };
+
+        std::array<id_shard_t, SHARD_COUNT>   m_ById;
+        std::array<name_shard_t, SHARD_COUNT> m_ByName;
+
+        static constexpr std::size_t shardIndex(const std::size_t hash) noexcept {
+            // take the top bits of a multiplicative hash, the maps inside the shard use the low bits of the same hashes for their buckets
+            return static_cast<std::size_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL) >> (64 - std::countr_zero(SHARD_COUNT)));
+        }
+
+        static_assert(std::has_single_bit(SHARD_COUNT) && SHARD_COUNT > 1);
+
+        static Aliases aliasesOf(const AssetBase &asset) noexcept;
+
+        NameLocks lockNames(const Aliases &aliases);
+        void      eraseNames(const Aliases &aliases, const AssetBase *asset); // the name shards must be locked
+        void      checkAliasFree(const AssetName &alias) const;             // the alias's name shard must be locked
+
+        inline id_shard_t &idShard(const asset_id_t id) noexcept { return m_ById[shardIndex(id)]; }
+
+        [[nodiscard]] inline const id_shard_t &idShard(const asset_id_t id) const noexcept { return m_ById[shardIndex(id)]; }
+
+        inline name_shard_t &nameShard(const std::size_t hash) noexcept { return m_ByName[shardIndex(hash)]; }
+
+        [[nodiscard]] inline const name_shard_t &nameShard(const std::size_t hash) const noexcept { return m_ByName[shardIndex(hash)]; }
+    };
+} // namespace game
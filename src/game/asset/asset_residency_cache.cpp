@@ -0,0 +1,40 @@
+//
+// Created by andy on 7/3/2025.
+//
+
+#include "asset_residency_cache.hpp"
+
+namespace game {
+    void AssetResidencyCache::touch(AssetBase *asset) {
+        if (const auto it = m_Index.find(asset); it != m_Index.end()) {
+            m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+            return;
+        }
+
+        const auto bytes = asset->footprint().total();
+        m_Entries.push_front({asset, bytes});
+        m_Index.emplace(asset, m_Entries.begin());
+        m_Bytes += bytes;
+    }
+
+    void AssetResidencyCache::remove(AssetBase *asset) {
+        const auto it = m_Index.find(asset);
+        if (it == m_Index.end())
+            return;
+
+        m_Bytes -= it->second->bytes;
+        m_Entries.erase(it->second);
+        m_Index.erase(it);
+    }
+
+    AssetBase *AssetResidencyCache::popOldest() {
+        if (m_Entries.empty())
+            return nullptr;
+
+        const auto [asset, bytes] = m_Entries.back();
+        m_Bytes -= bytes;
+        m_Index.erase(asset);
+        m_Entries.pop_back();
+        return asset;
+    }
+} // namespace game
@@ -0,0 +1,57 @@
+//
+// Created by andy on 7/3/2025.
+//
+
+#pragma once
+
+#include "game/asset/asset.hpp"
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+
+namespace game {
+    /**
+     * @brief Least recently used list of unreferenced assets the manager keeps resident instead of deleting, and the bytes they are charged for.
+     *
+     * Cached assets stay registered, so looking one up (or loading its path again) just hands out a new reference. The cache isn't told when that happens, references are
+     * taken without going through the manager. A revived asset keeps being charged until the manager finds it in use (when it next looks at it, or when it reaches the end of
+     * the list), so the charged bytes are an upper bound.
+     *
+     * Not thread safe, the manager only touches it with the loaded set lock held.
+     */
+    class AssetResidencyCache {
+      public:
+        /**
+         * @brief Add an asset as the most recently used, charging its current footprint (or move it to the front if it is already cached)
+         */
+        void touch(AssetBase *asset);
+
+        /**
+         * @brief Stop tracking an asset (nothing happens if it isn't cached)
+         */
+        void remove(AssetBase *asset);
+
+        /**
+         * @brief Remove the least recently used asset
+         * @return The asset, or nullptr if the cache is empty
+         */
+        AssetBase *popOldest();
+
+        [[nodiscard]] inline std::size_t bytes() const noexcept { return m_Bytes; }
+
+        [[nodiscard]] inline std::size_t size() const noexcept { return m_Entries.size(); }
+
+        [[nodiscard]] inline bool contains(AssetBase *asset) const { return m_Index.contains(asset); }
+
+      private:
+        struct Entry {
+            AssetBase  *asset;
+            std::size_t bytes; // what it was charged when it was added
+        };
+
+        std::list<Entry>                                            m_Entries; // most recently used first
+        std::unordered_map<AssetBase *, std::list<Entry>::iterator> m_Index;
+        std::size_t                                                 m_Bytes = 0;
+    };
+} // namespace game
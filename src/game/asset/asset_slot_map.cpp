@@ -0,0 +1,100 @@
+//
+// Created by andy on 6/27/2025.
+//
+
+#include "asset_slot_map.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace game {
+    static constexpr asset_id_t FIRST_GENERATION = 1; // so the zero id never resolves
+
+    asset_id_t AssetSlotMap::allocate(const asset_domain_t domainId) {
+        if (domainId == STATIC_DOMAIN)
+            throw std::invalid_argument("Can't allocate ids in the static domain");
+
+        auto           &d = domain(domainId);
+        std::lock_guard lock(d.mutex);
+
+        asset_id_t index;
+        if (!d.free.empty()) {
+            index = d.free.front();
+            d.free.pop_front();
+            return slot(d, index).id.load(std::memory_order::relaxed); // release already moved the slot to its next generation
+        }
+
+        if (d.next > ASSET_SLOT_MASK)
+            throw std::overflow_error("Asset id domain " + std::to_string(domainId) + " is out of slots");
+        index         = d.next++;
+        const auto id = makeAssetId(domainId, FIRST_GENERATION, index);
+        slot(d, index).id.store(id, std::memory_order::release);
+        return id;
+    }
+
+    void AssetSlotMap::publish(const asset_id_t id, AssetBase *asset) {
+        const auto domainId = assetIdDomain(id);
+        auto      &d        = domain(domainId);
+
+        std::lock_guard lock(d.mutex);
+        auto           &s = slot(d, assetIdSlot(id));
+        if (domainId == STATIC_DOMAIN) {
+            if (assetIdGeneration(id) != 0)
+                throw std::invalid_argument("Static asset ids must be below 2^" + std::to_string(ASSET_SLOT_BITS));
+            s.asset.store(asset, std::memory_order::release);
+            s.id.store(id, std::memory_order::release);
+            return;
+        }
+
+        if (s.id.load(std::memory_order::relaxed) != id)
+            throw std::invalid_argument("Asset id " + std::to_string(id) + " wasn't allocated (or has already been released)");
+        s.asset.store(asset, std::memory_order::release);
+    }
+
+    void AssetSlotMap::release(const asset_id_t id) {
+        const auto domainId = assetIdDomain(id);
+        auto      &d        = domain(domainId);
+
+        std::lock_guard lock(d.mutex);
+        const auto      index = assetIdSlot(id);
+        auto           &s     = slot(d, index);
+        if (s.id.load(std::memory_order::relaxed) != id)
+            return; // already released
+
+        s.asset.store(nullptr, std::memory_order::release);
+        if (domainId == STATIC_DOMAIN)
+            return; // static ids keep their slot, the slot just resolves to nothing until the id is registered again
+
+        // wraps past the last generation (skipping 0), retiring the slot instead would eventually run the domain out of slots in a long session
+        auto generation = assetIdGeneration(id) + 1;
+        if (generation > ASSET_GENERATION_MASK)
+            generation = FIRST_GENERATION;
+
+        s.id.store(makeAssetId(domainId, generation, index), std::memory_order::release);
+        d.free.push_back(index);
+    }
+
+    AssetSlotMap::Domain &AssetSlotMap::domain(const asset_domain_t domain) {
+        auto &entry = s_Domains[domain];
+        if (const auto existing = entry.load(std::memory_order::acquire))
+            return *existing;
+
+        auto   *created  = new Domain();
+        Domain *expected = nullptr;
+        if (!entry.compare_exchange_strong(expected, created, std::memory_order::acq_rel)) {
+            delete created; // another thread got there first
+            return *expected;
+        }
+        return *created;
+    }
+
+    AssetSlotMap::Slot &AssetSlotMap::slot(Domain &domain, const asset_id_t index) {
+        auto &segment = domain.segments[index >> SEGMENT_BITS];
+        auto *slots   = segment.load(std::memory_order::relaxed);
+        if (slots == nullptr) {
+            slots = new Slot[SEGMENT_SIZE];
+            segment.store(slots, std::memory_order::release);
+        }
+        return slots[index & (SEGMENT_SIZE - 1)];
+    }
+} // namespace game
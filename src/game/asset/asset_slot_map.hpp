@@ -0,0 +1,97 @@
+//
+// Created by andy on 6/27/2025.
+//
+
+#pragma once
+
+#include "game/asset/asset_id.hpp"
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+namespace game {
+    class AssetBase;
+
+    /**
+     * @brief Generational slot storage for registered assets, which is what asset ids (and so handles) resolve through.
+     *
+     * Every id domain has its own array of slots, and an id is its domain, the slot's generation and the slot index (see asset_format.md). A slot's generation is bumped each
+     * time its asset is released, so resolving a stale id fails the generation compare instead of returning a dangling pointer. Generations wrap around (skipping 0), so a
+     * stale id only resolves again if its slot was reused exactly a multiple of ASSET_GENERATION_MASK times (255 with 32-bit ids) since, and it then resolves to whatever
+     * asset holds the slot now. Free slots are reused oldest first, so that takes at least that many releases of every free slot in the domain. Typed lookups (AssetHandle::get)
+     * check the type tag, so such an id can never resolve to an asset of another type.
+     *
+     * Slot arrays are allocated in fixed size segments which are never moved or freed, so resolution doesn't need a lock. Resolution only guards against stale ids, it doesn't
+     * keep the asset alive: resolve inside an AssetReadGuard (or while holding a reference), which keeps the asset manager from freeing what was resolved until it ends.
+     *
+     * Static ids are placed in the slot given by their low ASSET_SLOT_BITS (so keep static ids below 2^ASSET_SLOT_BITS).
+     */
+    class AssetSlotMap {
+      public:
+        static constexpr unsigned    SEGMENT_BITS  = 10;
+        static constexpr std::size_t SEGMENT_SIZE  = std::size_t{1} << SEGMENT_BITS;
+        static constexpr std::size_t SEGMENT_COUNT = (static_cast<std::size_t>(ASSET_SLOT_MASK) + 1) / SEGMENT_SIZE;
+        static constexpr std::size_t DOMAIN_COUNT  = static_cast<std::size_t>(std::numeric_limits<asset_domain_t>::max()) + 1;
+
+        /**
+         * @brief Reserve a slot in a domain. The slot resolves to nothing until an asset is published to it.
+         * @return The id for the reserved slot
+         * @throws std::overflow_error if the domain has no free slots left
+         * @throws std::invalid_argument if the domain is the static domain (static ids are chosen, not allocated)
+         */
+        static asset_id_t allocate(asset_domain_t domain);
+
+        /**
+         * @brief Make an id resolve to an asset
+         * @param id An id reserved by allocate, or a static id
+         */
+        static void publish(asset_id_t id, AssetBase *asset);
+
+        /**
+         * @brief Release the slot an id refers to, so the id (and every copy of it) stops resolving. The slot is reused with the next generation.
+         */
+        static void release(asset_id_t id);
+
+        /**
+         * @return The asset an id refers to, or nullptr if the id is stale or was never published
+         */
+        static inline AssetBase *resolve(const asset_id_t id) noexcept {
+            const Domain *domain = s_Domains[assetIdDomain(id)].load(std::memory_order::acquire);
+            if (domain == nullptr)
+                return nullptr;
+
+            const auto  index   = assetIdSlot(id);
+            const Slot *segment = domain->segments[index >> SEGMENT_BITS].load(std::memory_order::acquire);
+            if (segment == nullptr)
+                return nullptr;
+
+            const Slot &slot = segment[index & (SEGMENT_SIZE - 1)];
+            if (slot.id.load(std::memory_order::acquire) != id)
+                return nullptr;
+
+            AssetBase *asset = slot.asset.load(std::memory_order::acquire);
+            // the slot may have been released and handed out again while we were reading it, in which case the id no longer matches
+            return slot.id.load(std::memory_order::acquire) == id ? asset : nullptr;
+        }
+
+      private:
+        struct Slot {
+            std::atomic<asset_id_t>  id{0}; // the id that currently resolves through this slot (including generation)
+            std::atomic<AssetBase *> asset{nullptr};
+        };
+
+        struct Domain {
+            std::array<std::atomic<Slot *>, SEGMENT_COUNT> segments{};
+            std::mutex                                     mutex; // guards allocation (segments, the free list and next)
+            std::deque<asset_id_t>                         free;  // slot indices, reused oldest first to spread generations out
+            asset_id_t                                     next = 0;
+        };
+
+        static inline std::array<std::atomic<Domain *>, DOMAIN_COUNT> s_Domains{};
+
+        static Domain &domain(asset_domain_t domain);
+        static Slot   &slot(Domain &domain, asset_id_t index); // domain.mutex must be held
+    };
+} // namespace game
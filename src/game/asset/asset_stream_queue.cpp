@@ -0,0 +1,174 @@
+//
+// Created by andy on 7/3/2025.
+//
+
+#include "asset_stream_queue.hpp"
+
+#include "game/asset/asset_manager.hpp"
+#include "game/profiler.hpp"
+#include "spdlog/spdlog.h"
+
+#include <ranges>
+
+namespace game {
+    AssetStreamQueue::AssetStreamQueue(AssetManager &assetManager) : m_AssetManager(assetManager) {}
+
+    AssetStreamQueue::~AssetStreamQueue() {
+        for (const auto &request : m_Requests | std::views::values) {
+            if (request.asset != nullptr)
+                AssetManager::discardUnregistered(request.asset);
+        }
+    }
+
+    AssetStreamQueue::request_t
+    AssetStreamQueue::request(const GenericAssetLoader<std::nullptr_t> *loader, const std::string &filename, const int priority, callback_t callback) {
+        request_t request;
+        {
+            std::lock_guard lock(m_Mutex);
+            request = m_NextRequest++;
+            m_Requests.emplace(request, Request{filename, m_AssetManager.loadFunction(loader, filename), &m_AssetManager.loaderTelemetry(loader), priority, std::move(callback)});
+            m_Queued.insert({priority, request});
+        }
+
+        // the worker takes whatever has the highest priority when it gets to run, not necessarily this request
+        m_AssetManager.loadPool().submit([this] { loadNext(); });
+        return request;
+    }
+
+    bool AssetStreamQueue::cancel(const request_t request) {
+        AssetBase      *asset = nullptr;
+        GenericAssetRef existing(nullptr); // released outside the lock
+        {
+            std::lock_guard lock(m_Mutex);
+            const auto      it = m_Requests.find(request);
+            if (it == m_Requests.end())
+                return false;
+
+            auto &r = it->second;
+            if (r.state == State::Queued) {
+                m_Queued.erase({r.priority, request});
+            } else if (r.state == State::Ready) {
+                m_Ready.erase({r.priority, request});
+                asset    = r.asset;
+                existing = std::move(r.existing);
+            }
+            m_Requests.erase(it); // a load in progress finds its request gone when it finishes, and drops what it loaded
+        }
+
+        if (asset != nullptr)
+            AssetManager::discardUnregistered(asset);
+        return true;
+    }
+
+    bool AssetStreamQueue::reprioritize(const request_t request, const int priority) {
+        std::lock_guard lock(m_Mutex);
+        const auto      it = m_Requests.find(request);
+        if (it == m_Requests.end())
+            return false;
+
+        auto &r = it->second;
+        if (r.state == State::Queued) {
+            m_Queued.erase({r.priority, request});
+            m_Queued.insert({priority, request});
+        } else if (r.state == State::Ready) {
+            m_Ready.erase({r.priority, request});
+            m_Ready.insert({priority, request});
+        }
+        r.priority = priority;
+        return true;
+    }
+
+    std::size_t AssetStreamQueue::finalize(const std::chrono::microseconds budget) {
+        const auto  deadline  = std::chrono::steady_clock::now() + budget;
+        std::size_t finalized = 0;
+        do {
+            decltype(m_Requests)::node_type node;
+            {
+                std::lock_guard lock(m_Mutex);
+                if (m_Ready.empty())
+                    break;
+                node = m_Requests.extract(m_Ready.begin()->request);
+                m_Ready.erase(m_Ready.begin());
+            }
+
+            auto           &r   = node.mapped();
+            GenericAssetRef ref = std::move(r.existing);
+            try {
+                if (r.error)
+                    std::rethrow_exception(r.error);
+                if (r.asset != nullptr)
+                    ref = m_AssetManager.registerLoadedAsset(r.asset, r.filename, {std::move(r.files), std::move(r.load), r.telemetry}); // deletes the asset if it throws
+            } catch (const std::exception &e) {
+                spdlog::error("Failed to stream in '{}': {}", r.filename, e.what());
+            }
+
+            if (r.callback)
+                r.callback(std::move(ref));
+            finalized++;
+        } while (std::chrono::steady_clock::now() < deadline);
+
+        return finalized;
+    }
+
+    std::size_t AssetStreamQueue::pending() const {
+        std::lock_guard lock(m_Mutex);
+        return m_Requests.size();
+    }
+
+    void AssetStreamQueue::loadNext() {
+        GAME_PROFILE_ZONE("AssetStreamQueue::loadNext");
+        request_t                              request;
+        std::string                            filename;
+        std::function<AssetBase *(asset_id_t)> load;
+        LoaderTelemetry                       *telemetry;
+        {
+            std::lock_guard lock(m_Mutex);
+            if (m_Queued.empty())
+                return; // cancelled (or taken by an earlier worker, which leaves this worker's request for the next one)
+
+            request = m_Queued.begin()->request;
+            m_Queued.erase(m_Queued.begin());
+
+            auto &r   = m_Requests.at(request);
+            r.state   = State::Loading;
+            filename  = r.filename;
+            load      = r.load;
+            telemetry = r.telemetry;
+        }
+
+        // the CPU side of the load (reading, decompressing, parsing) happens here, finalize only registers the asset
+        AssetBase             *asset = nullptr;
+        GenericAssetRef        existing(nullptr);
+        std::vector<AssetName> files;
+        std::exception_ptr     error;
+        try {
+            if (auto found = m_AssetManager.findLoaded(filename)) {
+                telemetry->cacheHits.fetch_add(1, std::memory_order::relaxed);
+                existing = std::move(found);
+            } else {
+                asset_util::FileReadRecorder recorder;
+                asset = m_AssetManager.withNewId(load);
+                files = recorder.take();
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard lock(m_Mutex);
+            if (const auto it = m_Requests.find(request); it != m_Requests.end()) {
+                auto &r    = it->second;
+                r.state    = State::Ready;
+                r.asset    = asset;
+                r.existing = std::move(existing);
+                r.files    = std::move(files);
+                r.error    = error;
+                m_Ready.insert({r.priority, request});
+                return;
+            }
+        }
+
+        if (asset != nullptr)
+            AssetManager::discardUnregistered(asset); // cancelled while it was loading
+    }
+} // namespace game
@@ -0,0 +1,136 @@
+//
+// Created by andy on 7/3/2025.
+//
+
+#pragma once
+
+#include "game/asset/asset.hpp"
+#include "game/asset/asset_loader.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace game {
+    class AssetManager;
+
+    /**
+     * @brief Prioritized queue for streaming assets in while the game runs.
+     *
+     * Requests are loaded on the asset load pool, highest priority first (ties in the order they were made). Finishing a load (registering the asset and running the request's
+     * callback) happens on the main thread in finalize, which stops once it has used up its time budget, so streaming never takes more than a fixed slice of a frame.
+     *
+     * Requests can be cancelled or given a new priority until they are finalized. The queue is owned by the AssetManager (see AssetManager::streamQueue).
+     */
+    class AssetStreamQueue {
+      public:
+        /**
+         * @brief Identifies a request (0 is never a valid request)
+         */
+        using request_t = uint64_t;
+
+        /**
+         * @brief Called on the main thread when a request is finalized, with the asset (or an empty reference if the load failed)
+         */
+        using callback_t = std::move_only_function<void(GenericAssetRef)>;
+
+        explicit AssetStreamQueue(AssetManager &assetManager);
+
+        /**
+         * @brief Drops every request that hasn't been finalized (the load pool must be stopped first, so nothing is still loading)
+         */
+        ~AssetStreamQueue();
+
+        AssetStreamQueue(const AssetStreamQueue &other)                = delete;
+        AssetStreamQueue(AssetStreamQueue &&other) noexcept            = delete;
+        AssetStreamQueue &operator=(const AssetStreamQueue &other)     = delete;
+        AssetStreamQueue &operator=(AssetStreamQueue &&other) noexcept = delete;
+
+        /**
+         * @brief Request an asset be streamed in
+         * @param loader The loader to load the asset with
+         * @param filename The path to the asset (relative to the assets directory)
+         * @param priority Higher priorities are loaded and finalized first
+         * @param callback Called when the request is finalized (not called if it is cancelled)
+         * @return The request
+         */
+        request_t request(const GenericAssetLoader<std::nullptr_t> *loader, const std::string &filename, int priority, callback_t callback = {});
+
+        /**
+         * @brief Cancel a request. An asset that already finished loading is dropped, one that is still loading is dropped when it finishes.
+         * @return If the request was still pending (false once it has been finalized or cancelled)
+         */
+        bool cancel(request_t request);
+
+        /**
+         * @brief Change the priority of a request. This reorders both the loads that haven't started and the finalization of loads that have finished.
+         * @return If the request was still pending
+         */
+        bool reprioritize(request_t request, int priority);
+
+        /**
+         * @brief Finalize finished loads, highest priority first, until the budget is used up. Call this once per frame on the main thread.
+         *
+         * At least one load is finalized per call (if one is ready), so a budget smaller than a single finalization still makes progress.
+         *
+         * @param budget How long this may take
+         * @return The number of requests finalized
+         */
+        std::size_t finalize(std::chrono::microseconds budget);
+
+        /**
+         * @return The number of requests that haven't been finalized or cancelled
+         */
+        [[nodiscard]] std::size_t pending() const;
+
+      private:
+        enum class State {
+            Queued,  // waiting for a load pool worker
+            Loading, // on a worker
+            Ready,   // loaded, waiting for finalize
+        };
+
+        /**
+         * @brief The order requests are loaded and finalized in: highest priority first, then oldest first.
+         */
+        struct Order {
+            int       priority;
+            request_t request;
+
+            inline bool operator<(const Order &rhs) const noexcept { return priority != rhs.priority ? priority > rhs.priority : request < rhs.request; }
+        };
+
+        struct Request {
+            std::string                            filename;
+            std::function<AssetBase *(asset_id_t)> load;
+            LoaderTelemetry                       *telemetry;
+            int                                    priority;
+            callback_t                             callback;
+            State                                  state = State::Queued;
+
+            // the result of the load, once it is ready
+            AssetBase             *asset = nullptr;   // a fresh load that still has to be registered
+            GenericAssetRef        existing{nullptr}; // the registered asset instead, if the path was already loaded
+            std::vector<AssetName> files;
+            std::exception_ptr     error;
+        };
+
+        AssetManager &m_AssetManager;
+
+        mutable std::mutex                     m_Mutex;
+        request_t                              m_NextRequest = 1;
+        std::unordered_map<request_t, Request> m_Requests;
+        std::set<Order>                        m_Queued; // not started yet
+        std::set<Order>                        m_Ready;  // loaded, waiting for finalize
+
+        /**
+         * @brief Load the highest priority queued request (runs on the load pool, one is submitted per request, so there is always one for each queued request)
+         */
+        void loadNext();
+    };
+} // namespace game
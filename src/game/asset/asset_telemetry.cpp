@@ -0,0 +1,185 @@
+//
+// Created by andy on 7/6/2025.
+//
+
+#include "asset_telemetry.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <ranges>
+#include <stdexcept>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+namespace game {
+    void LatencyHistogram::record(const std::chrono::nanoseconds duration) noexcept {
+        const auto nanoseconds  = static_cast<uint64_t>(std::max<std::chrono::nanoseconds::rep>(duration.count(), 0));
+        const auto microseconds = nanoseconds / 1000;
+        const auto bucket       = std::min<std::size_t>(microseconds == 0 ? 0 : std::bit_width(microseconds) - 1, BUCKETS - 1);
+
+        m_Buckets[bucket].fetch_add(1, std::memory_order::relaxed);
+        m_Count.fetch_add(1, std::memory_order::relaxed);
+        m_Total.fetch_add(nanoseconds, std::memory_order::relaxed);
+
+        uint64_t max = m_Max.load(std::memory_order::relaxed);
+        while (nanoseconds > max && !m_Max.compare_exchange_weak(max, nanoseconds, std::memory_order::relaxed)) {}
+    }
+
+    std::chrono::nanoseconds LatencyHistogram::quantile(const double q) const noexcept {
+        const auto count = this->count();
+        if (count == 0)
+            return std::chrono::nanoseconds(0);
+
+        const auto target = std::max<uint64_t>(static_cast<uint64_t>(q * static_cast<double>(count) + 0.5), 1);
+        uint64_t   seen   = 0;
+        for (std::size_t i = 0; i < BUCKETS - 1; i++) {
+            seen += m_Buckets[i].load(std::memory_order::relaxed);
+            if (seen >= target)
+                return std::min(std::chrono::nanoseconds(std::chrono::microseconds(uint64_t{2} << i)), max());
+        }
+        return max();
+    }
+
+    nlohmann::json LatencyHistogram::toJson() const {
+        const auto micros = [](const std::chrono::nanoseconds duration) { return static_cast<double>(duration.count()) / 1000.0; };
+        const auto count  = this->count();
+        return {
+            {"count", count},
+            {"total_us", micros(total())},
+            {"mean_us", count == 0 ? 0.0 : micros(total()) / static_cast<double>(count)},
+            {"p50_us", micros(quantile(0.5))},
+            {"p95_us", micros(quantile(0.95))},
+            {"p99_us", micros(quantile(0.99))},
+            {"max_us", micros(max())},
+        };
+    }
+
+    nlohmann::json LoaderTelemetry::toJson() const {
+        return {
+            {"loads", loads.load(std::memory_order::relaxed)},
+            {"failures", failures.load(std::memory_order::relaxed)},
+            {"bytes_read", bytesRead.load(std::memory_order::relaxed)},
+            {"cache_hits", cacheHits.load(std::memory_order::relaxed)},
+            {"metadata_cache_hits", metadataCacheHits.load(std::memory_order::relaxed)},
+            {"reclaimed", reclaimed.load(std::memory_order::relaxed)},
+            {"load_time", loadTime.toJson()},
+            {"read_time", readTime.toJson()},
+            {"parse_time", parseTime.toJson()},
+            {"create_time", createTime.toJson()},
+        };
+    }
+
+    static std::string typeName(const std::type_index type) {
+#if defined(__GNUG__)
+        int   status    = 0;
+        char *demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+        if (status == 0 && demangled != nullptr) {
+            std::string name(demangled);
+            std::free(demangled);
+            return name;
+        }
+#endif
+        return type.name();
+    }
+
+    void AssetTelemetry::nameLoader(const std::type_index loader, std::string name) {
+        std::lock_guard lock(m_Mutex);
+        if (const auto it = m_Loaders.find(loader); it != m_Loaders.end())
+            it->second->name = name;
+        m_Names.insert_or_assign(loader, std::move(name));
+    }
+
+    LoaderTelemetry &AssetTelemetry::loader(const std::type_index loader) {
+        {
+            std::shared_lock lock(m_Mutex);
+            if (const auto it = m_Loaders.find(loader); it != m_Loaders.end())
+                return *it->second;
+        }
+
+        std::lock_guard lock(m_Mutex);
+        auto [it, inserted] = m_Loaders.try_emplace(loader);
+        if (inserted) {
+            it->second       = std::make_unique<LoaderTelemetry>();
+            const auto name  = m_Names.find(loader);
+            it->second->name = name != m_Names.end() ? name->second : typeName(loader);
+        }
+        return *it->second;
+    }
+
+    const LoaderTelemetry *AssetTelemetry::find(const std::string_view name) const {
+        std::shared_lock lock(m_Mutex);
+        for (const auto &telemetry : m_Loaders | std::views::values) {
+            if (telemetry->name == name)
+                return telemetry.get();
+        }
+        return nullptr;
+    }
+
+    std::vector<const LoaderTelemetry *> AssetTelemetry::loaders() const {
+        std::vector<const LoaderTelemetry *> loaders;
+        {
+            std::shared_lock lock(m_Mutex);
+            for (const auto &telemetry : m_Loaders | std::views::values) {
+                loaders.push_back(telemetry.get());
+            }
+        }
+        std::ranges::sort(loaders, {}, &LoaderTelemetry::name);
+        return loaders;
+    }
+
+    nlohmann::json AssetTelemetry::toJson() const {
+        auto json = nlohmann::json::object();
+        for (const auto *telemetry : loaders()) {
+            json[telemetry->name] = telemetry->toJson();
+        }
+        return json;
+    }
+
+    void AssetTelemetry::save(const std::filesystem::path &path) const {
+        std::ofstream out(path, std::ios::trunc);
+        out << toJson().dump(4) << '\n';
+        if (!out)
+            throw std::runtime_error("Failed to write asset telemetry '" + path.string() + "'");
+    }
+
+    namespace asset_util {
+        LoadTimer::LoadTimer(LoaderTelemetry &telemetry) noexcept : m_Telemetry(telemetry), m_Previous(s_Current), m_Start(std::chrono::steady_clock::now()) {
+            s_Current = this;
+        }
+
+        LoadTimer::~LoadTimer() {
+            s_Current          = m_Previous;
+            const auto elapsed = std::chrono::steady_clock::now() - m_Start;
+            if (m_Previous != nullptr)
+                m_Previous->m_Nested += elapsed;
+
+            m_Telemetry.loads.fetch_add(1, std::memory_order::relaxed);
+            if (!m_Succeeded)
+                m_Telemetry.failures.fetch_add(1, std::memory_order::relaxed);
+            m_Telemetry.loadTime.record(elapsed - m_Nested);
+            m_Telemetry.readTime.record(m_Read);
+            m_Telemetry.parseTime.record(m_Parse);
+            m_Telemetry.createTime.record(elapsed - m_Nested - m_Read - m_Parse);
+        }
+
+        void LoadTimer::recordRead(const std::chrono::steady_clock::time_point start, const std::size_t bytes) noexcept {
+            if (s_Current == nullptr)
+                return;
+            s_Current->m_Read += std::chrono::steady_clock::now() - start;
+            s_Current->m_Telemetry.bytesRead.fetch_add(bytes, std::memory_order::relaxed);
+        }
+
+        void LoadTimer::recordParse(const std::chrono::steady_clock::time_point start, const bool cached) noexcept {
+            if (s_Current == nullptr)
+                return;
+            s_Current->m_Parse += std::chrono::steady_clock::now() - start;
+            if (cached)
+                s_Current->m_Telemetry.metadataCacheHits.fetch_add(1, std::memory_order::relaxed);
+        }
+    } // namespace asset_util
+} // namespace game
@@ -0,0 +1,171 @@
+//
+// Created by andy on 7/6/2025.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <shared_mutex>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace game {
+    /**
+     * @brief A lock-free latency histogram with power of two buckets (bucket i counts samples under 2^(i+1) microseconds, the last bucket takes everything longer).
+     *
+     * Quantiles are reported as the upper bound of the bucket they fall in, so they are accurate to within a factor of two, which is plenty to tell a 50us parse from a 5ms
+     * one.
+     */
+    class LatencyHistogram {
+      public:
+        static constexpr std::size_t BUCKETS = 32;
+
+        void record(std::chrono::nanoseconds duration) noexcept;
+
+        [[nodiscard]] inline uint64_t count() const noexcept { return m_Count.load(std::memory_order::relaxed); }
+
+        [[nodiscard]] inline std::chrono::nanoseconds total() const noexcept { return std::chrono::nanoseconds(m_Total.load(std::memory_order::relaxed)); }
+
+        [[nodiscard]] inline std::chrono::nanoseconds max() const noexcept { return std::chrono::nanoseconds(m_Max.load(std::memory_order::relaxed)); }
+
+        /**
+         * @param q The quantile, from 0 to 1
+         * @return The upper bound of the bucket the quantile falls in (0 if nothing was recorded)
+         */
+        [[nodiscard]] std::chrono::nanoseconds quantile(double q) const noexcept;
+
+        /**
+         * @return count, total, mean, p50, p95, p99 and max (times in microseconds)
+         */
+        [[nodiscard]] nlohmann::json toJson() const;
+
+      private:
+        std::array<std::atomic<uint64_t>, BUCKETS> m_Buckets{};
+        std::atomic<uint64_t>                      m_Count = 0;
+        std::atomic<uint64_t>                      m_Total = 0; // nanoseconds
+        std::atomic<uint64_t>                      m_Max   = 0; // nanoseconds
+    };
+
+    /**
+     * @brief Counters and latencies for every load made with one loader.
+     *
+     * A load's time is split into reading (asset_util::readAsset, including decompression), parsing (asset_util::parseMetadata) and creating (everything else the loader
+     * does, like creating vulkan objects). Time spent in other loads started from inside a load (a bundle's entries) is only counted for those loads.
+     */
+    struct LoaderTelemetry {
+        std::string name;
+
+        std::atomic<uint64_t> loads             = 0; // including failed ones and hot reloads
+        std::atomic<uint64_t> failures          = 0;
+        std::atomic<uint64_t> bytesRead         = 0; // as stored, before decompression
+        std::atomic<uint64_t> cacheHits         = 0; // loads answered with an asset that was already loaded (or resident)
+        std::atomic<uint64_t> metadataCacheHits = 0; // parses answered by the metadata cache
+        std::atomic<uint64_t> reclaimed         = 0; // assets deleted by the gc
+
+        LatencyHistogram loadTime;
+        LatencyHistogram readTime;
+        LatencyHistogram parseTime;
+        LatencyHistogram createTime;
+
+        [[nodiscard]] nlohmann::json toJson() const;
+    };
+
+    /**
+     * @brief Per-loader load telemetry, owned by the AssetManager (see AssetManager::telemetry).
+     *
+     * Loaders are told apart by type. Loaders the manager registers by name report under that name, any other loader under its type name. Everything here may be used from
+     * any thread, and counters can be read while loads are running.
+     */
+    class AssetTelemetry {
+      public:
+        /**
+         * @brief Report a loader type under a name
+         */
+        void nameLoader(std::type_index loader, std::string name);
+
+        /**
+         * @return The telemetry of a loader type (created on first use, and never moved or freed while this object is alive)
+         */
+        LoaderTelemetry &loader(std::type_index loader);
+
+        /**
+         * @return The telemetry reported under a name, or nullptr if nothing has been loaded with that loader yet
+         */
+        [[nodiscard]] const LoaderTelemetry *find(std::string_view name) const;
+
+        /**
+         * @return Every loader's telemetry, sorted by name
+         */
+        [[nodiscard]] std::vector<const LoaderTelemetry *> loaders() const;
+
+        /**
+         * @return An object mapping loader names to their telemetry
+         */
+        [[nodiscard]] nlohmann::json toJson() const;
+
+        /**
+         * @brief Write toJson to a file
+         * @throws std::runtime_error if the file can't be written
+         */
+        void save(const std::filesystem::path &path) const;
+
+      private:
+        mutable std::shared_mutex                                             m_Mutex;
+        std::unordered_map<std::type_index, std::string>                      m_Names;
+        std::unordered_map<std::type_index, std::unique_ptr<LoaderTelemetry>> m_Loaders;
+    };
+
+    namespace asset_util {
+        /**
+         * @brief Times a load on the current thread and records it with a loader's telemetry when it goes out of scope (as a failure unless succeed was called).
+         *
+         * Reads and parses on the thread while the timer is alive are charged to it. Timers nest: a load started inside another load gets its own timer, and its time is taken
+         * out of the outer load's create time.
+         */
+        class LoadTimer {
+          public:
+            explicit LoadTimer(LoaderTelemetry &telemetry) noexcept;
+            ~LoadTimer();
+
+            LoadTimer(const LoadTimer &other)                = delete;
+            LoadTimer(LoadTimer &&other) noexcept            = delete;
+            LoadTimer &operator=(const LoadTimer &other)     = delete;
+            LoadTimer &operator=(LoadTimer &&other) noexcept = delete;
+
+            inline void succeed() noexcept { m_Succeeded = true; }
+
+            /**
+             * @brief Charge a read to the innermost timer on this thread (if there is one)
+             * @param start When the read started (it ends now)
+             * @param bytes The bytes read
+             */
+            static void recordRead(std::chrono::steady_clock::time_point start, std::size_t bytes) noexcept;
+
+            /**
+             * @brief Charge a parse to the innermost timer on this thread (if there is one)
+             * @param start When the parse started (it ends now)
+             * @param cached If the metadata cache had the parsed form
+             */
+            static void recordParse(std::chrono::steady_clock::time_point start, bool cached) noexcept;
+
+          private:
+            static inline thread_local LoadTimer *s_Current = nullptr;
+
+            LoaderTelemetry                      &m_Telemetry;
+            LoadTimer                            *m_Previous;
+            std::chrono::steady_clock::time_point m_Start;
+            std::chrono::nanoseconds              m_Read{0};
+            std::chrono::nanoseconds              m_Parse{0};
+            std::chrono::nanoseconds              m_Nested{0}; // spent in nested loads
+            bool                                  m_Succeeded = false;
+        };
+    } // namespace asset_util
+} // namespace game
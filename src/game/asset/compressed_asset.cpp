@@ -0,0 +1,353 @@
+//
+// Created by andy on 6/24/2025.
+//
+
+#include "compressed_asset.hpp"
+
+#include "game/asset/asset_load_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace game {
+    namespace {
+        // raw DEFLATE (RFC 1951) decoder. The output size is always known up front, so this writes straight into the destination and never grows anything.
+
+        class BitReader {
+          public:
+            explicit BitReader(const std::span<const unsigned char> data) : m_Data(data) {}
+
+            uint32_t peek(const unsigned n) {
+                if (m_Count < n)
+                    refill();
+                return static_cast<uint32_t>(m_Bits & ((1ULL << n) - 1));
+            }
+
+            void consume(const unsigned n) {
+                m_Bits >>= n;
+                m_Count -= n;
+                m_Consumed += n;
+                if (m_Consumed > m_Data.size() * 8)
+                    throw std::runtime_error("Compressed asset block is truncated");
+            }
+
+            uint32_t bits(const unsigned n) {
+                const auto v = peek(n);
+                consume(n);
+                return v;
+            }
+
+            /**
+             * @brief Skip to the next byte boundary and take n raw bytes (for stored blocks).
+             */
+            std::span<const unsigned char> takeBytes(const std::size_t n) {
+                const std::size_t bytePos = (m_Consumed + 7) / 8;
+                if (bytePos > m_Data.size() || m_Data.size() - bytePos < n)
+                    throw std::runtime_error("Compressed asset block is truncated");
+
+                m_Bits     = 0;
+                m_Count    = 0;
+                m_Pos      = bytePos + n;
+                m_Consumed = m_Pos * 8;
+                return m_Data.subspan(bytePos, n);
+            }
+
+            void alignToByte() { consume(static_cast<unsigned>((8 - m_Consumed % 8) % 8)); }
+
+          private:
+            std::span<const unsigned char> m_Data;
+            std::size_t                    m_Pos      = 0;
+            std::size_t                    m_Consumed = 0;
+            uint64_t                       m_Bits     = 0;
+            unsigned                       m_Count    = 0;
+
+            void refill() {
+                while (m_Count <= 56) {
+                    const uint64_t byte = m_Pos < m_Data.size() ? m_Data[m_Pos] : 0; // past the end reads as zeros, consume() catches actual overruns
+                    ++m_Pos;
+                    m_Bits |= byte << m_Count;
+                    m_Count += 8;
+                }
+            }
+        };
+
+        constexpr unsigned MAX_CODE_BITS = 15;
+        constexpr unsigned MAX_LITLEN    = 288;
+        constexpr unsigned MAX_DIST      = 30;
+
+        /**
+         * @brief Canonical huffman decoder with a lookup table for short codes (falls back to walking the code lengths for longer ones).
+         */
+        class Huffman {
+          public:
+            static constexpr unsigned FAST_BITS = 10;
+
+            void build(const uint8_t *lengths, const unsigned n) {
+                m_Counts.fill(0);
+                m_Fast.fill(0);
+                for (unsigned sym = 0; sym < n; ++sym) {
+                    ++m_Counts[lengths[sym]];
+                }
+                m_Counts[0] = 0;
+
+                int left = 1;
+                for (unsigned len = 1; len <= MAX_CODE_BITS; ++len) {
+                    left <<= 1;
+                    left -= m_Counts[len];
+                    if (left < 0)
+                        throw std::runtime_error("Compressed asset block has an over-subscribed huffman code");
+                }
+
+                std::array<uint16_t, MAX_CODE_BITS + 2> offsets{};
+                std::array<uint32_t, MAX_CODE_BITS + 1> nextCode{};
+                uint32_t                                code = 0;
+                for (unsigned len = 1; len <= MAX_CODE_BITS; ++len) {
+                    offsets[len + 1] = offsets[len] + m_Counts[len];
+                    code             = (code + m_Counts[len - 1]) << 1;
+                    nextCode[len]    = code;
+                }
+
+                for (unsigned sym = 0; sym < n; ++sym) {
+                    const unsigned len = lengths[sym];
+                    if (len == 0)
+                        continue;
+                    m_Symbols[offsets[len]++] = static_cast<uint16_t>(sym);
+
+                    const uint32_t symCode = nextCode[len]++;
+                    if (len <= FAST_BITS) {
+                        // codes are stored most significant bit first, but we read least significant bit first
+                        uint32_t reversed = 0;
+                        for (unsigned i = 0; i < len; ++i) {
+                            reversed |= ((symCode >> i) & 1U) << (len - 1 - i);
+                        }
+                        for (uint32_t e = reversed; e < (1U << FAST_BITS); e += 1U << len) {
+                            m_Fast[e] = static_cast<uint16_t>((sym << 4) | len);
+                        }
+                    }
+                }
+            }
+
+            unsigned decode(BitReader &reader) const {
+                if (const auto entry = m_Fast[reader.peek(FAST_BITS)]; entry != 0) {
+                    reader.consume(entry & 0xF);
+                    return entry >> 4;
+                }
+
+                int code = 0, first = 0, index = 0;
+                for (unsigned len = 1; len <= MAX_CODE_BITS; ++len) {
+                    code |= static_cast<int>(reader.bits(1));
+                    const int count = m_Counts[len];
+                    if (code - count < first)
+                        return m_Symbols[index + (code - first)];
+                    index += count;
+                    first += count;
+                    first <<= 1;
+                    code <<= 1;
+                }
+                throw std::runtime_error("Compressed asset block has an invalid huffman code");
+            }
+
+          private:
+            std::array<uint16_t, 1U << FAST_BITS>  m_Fast{}; // (symbol << 4) | length, 0 when the code is longer than FAST_BITS
+            std::array<uint16_t, MAX_CODE_BITS + 1> m_Counts{};
+            std::array<uint16_t, MAX_LITLEN>        m_Symbols{};
+        };
+
+        constexpr std::array<uint16_t, 29> LENGTH_BASE  = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        constexpr std::array<uint8_t, 29>  LENGTH_EXTRA = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        constexpr std::array<uint16_t, 30> DIST_BASE    = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                                           193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        constexpr std::array<uint8_t, 30>  DIST_EXTRA   = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+        constexpr std::array<uint8_t, 19>  CODE_LENGTH_ORDER = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+        struct FixedTables {
+            Huffman litlen;
+            Huffman dist;
+
+            FixedTables() {
+                std::array<uint8_t, MAX_LITLEN> lengths{};
+                std::fill(lengths.begin(), lengths.begin() + 144, 8);
+                std::fill(lengths.begin() + 144, lengths.begin() + 256, 9);
+                std::fill(lengths.begin() + 256, lengths.begin() + 280, 7);
+                std::fill(lengths.begin() + 280, lengths.end(), 8);
+                litlen.build(lengths.data(), MAX_LITLEN);
+
+                lengths.fill(5);
+                dist.build(lengths.data(), MAX_DIST);
+            }
+        };
+
+        void inflateCodes(BitReader &reader, const Huffman &litlen, const Huffman &dist, const std::span<unsigned char> out, std::size_t &outPos) {
+            while (true) {
+                const unsigned sym = litlen.decode(reader);
+                if (sym < 256) {
+                    if (outPos >= out.size())
+                        throw std::runtime_error("Compressed asset block is larger than declared");
+                    out[outPos++] = static_cast<unsigned char>(sym);
+                    continue;
+                }
+                if (sym == 256)
+                    return;
+
+                const unsigned lengthSym = sym - 257;
+                if (lengthSym >= LENGTH_BASE.size())
+                    throw std::runtime_error("Compressed asset block has an invalid length code");
+                const std::size_t length = LENGTH_BASE[lengthSym] + reader.bits(LENGTH_EXTRA[lengthSym]);
+
+                const unsigned distSym = dist.decode(reader);
+                if (distSym >= DIST_BASE.size())
+                    throw std::runtime_error("Compressed asset block has an invalid distance code");
+                const std::size_t distance = DIST_BASE[distSym] + reader.bits(DIST_EXTRA[distSym]);
+
+                if (distance > outPos)
+                    throw std::runtime_error("Compressed asset block references data before its start");
+                if (out.size() - outPos < length)
+                    throw std::runtime_error("Compressed asset block is larger than declared");
+
+                // byte by byte since the source and destination may overlap (that's how runs are encoded)
+                for (std::size_t i = 0; i < length; ++i, ++outPos) {
+                    out[outPos] = out[outPos - distance];
+                }
+            }
+        }
+
+        void inflateDynamic(BitReader &reader, const std::span<unsigned char> out, std::size_t &outPos) {
+            const unsigned litlenCount = reader.bits(5) + 257;
+            const unsigned distCount   = reader.bits(5) + 1;
+            const unsigned codeCount   = reader.bits(4) + 4;
+            if (litlenCount > 286 || distCount > MAX_DIST)
+                throw std::runtime_error("Compressed asset block has too many huffman codes");
+
+            std::array<uint8_t, 19> codeLengthLengths{};
+            for (unsigned i = 0; i < codeCount; ++i) {
+                codeLengthLengths[CODE_LENGTH_ORDER[i]] = static_cast<uint8_t>(reader.bits(3));
+            }
+            Huffman codeLengths;
+            codeLengths.build(codeLengthLengths.data(), codeLengthLengths.size());
+
+            std::array<uint8_t, MAX_LITLEN + MAX_DIST> lengths{};
+            for (unsigned i = 0; i < litlenCount + distCount;) {
+                const unsigned sym = codeLengths.decode(reader);
+                if (sym < 16) {
+                    lengths[i++] = static_cast<uint8_t>(sym);
+                    continue;
+                }
+
+                uint8_t  value  = 0;
+                unsigned repeat = 0;
+                if (sym == 16) {
+                    if (i == 0)
+                        throw std::runtime_error("Compressed asset block repeats a code length with no previous length");
+                    value  = lengths[i - 1];
+                    repeat = 3 + reader.bits(2);
+                } else if (sym == 17) {
+                    repeat = 3 + reader.bits(3);
+                } else {
+                    repeat = 11 + reader.bits(7);
+                }
+
+                if (i + repeat > litlenCount + distCount)
+                    throw std::runtime_error("Compressed asset block has too many code lengths");
+                std::fill_n(lengths.begin() + i, repeat, value);
+                i += repeat;
+            }
+
+            if (lengths[256] == 0)
+                throw std::runtime_error("Compressed asset block has no end of block code");
+
+            Huffman litlen, dist;
+            litlen.build(lengths.data(), litlenCount);
+            dist.build(lengths.data() + litlenCount, distCount);
+            inflateCodes(reader, litlen, dist, out, outPos);
+        }
+
+        void inflate(const std::span<const unsigned char> in, const std::span<unsigned char> out) {
+            static const FixedTables fixed;
+
+            BitReader   reader(in);
+            std::size_t outPos = 0;
+            bool        last;
+            do {
+                last = reader.bits(1) != 0;
+                switch (reader.bits(2)) {
+                case 0: {
+                    reader.alignToByte();
+                    const uint32_t length  = reader.bits(16);
+                    const uint32_t nlength = reader.bits(16);
+                    if (length != (~nlength & 0xFFFF))
+                        throw std::runtime_error("Compressed asset block has a corrupt stored block");
+                    if (out.size() - outPos < length)
+                        throw std::runtime_error("Compressed asset block is larger than declared");
+                    const auto bytes = reader.takeBytes(length);
+                    std::copy(bytes.begin(), bytes.end(), out.begin() + static_cast<std::ptrdiff_t>(outPos));
+                    outPos += length;
+                    break;
+                }
+                case 1:
+                    inflateCodes(reader, fixed.litlen, fixed.dist, out, outPos);
+                    break;
+                case 2:
+                    inflateDynamic(reader, out, outPos);
+                    break;
+                default:
+                    throw std::runtime_error("Compressed asset block has an invalid block type");
+                }
+            } while (!last);
+
+            if (outPos != out.size())
+                throw std::runtime_error("Compressed asset block is smaller than declared");
+        }
+    } // namespace
+
+    bool isCompressedAsset(const std::span<const unsigned char> data) noexcept {
+        if (data.size() < sizeof(CompressedAssetHeader))
+            return false;
+        uint32_t magic;
+        std::memcpy(&magic, data.data(), sizeof(magic));
+        return magic == CompressedAssetHeader::MAGIC;
+    }
+
+    std::vector<unsigned char> decompressAsset(const std::span<const unsigned char> data) {
+        if (!isCompressedAsset(data))
+            throw std::runtime_error("Not a compressed asset");
+
+        CompressedAssetHeader header;
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (header.version != CompressedAssetHeader::VERSION)
+            throw std::runtime_error("Unsupported compressed asset version " + std::to_string(header.version));
+        if ((data.size() - sizeof(header)) / sizeof(CompressedAssetBlock) < header.blockCount)
+            throw std::runtime_error("Compressed asset block table is truncated");
+
+        std::vector<CompressedAssetBlock> blocks(header.blockCount);
+        std::memcpy(blocks.data(), data.data() + sizeof(header), blocks.size() * sizeof(CompressedAssetBlock));
+
+        // every block's output location is known up front, so they can be decoded in any order
+        std::vector<std::size_t> outputOffsets(blocks.size());
+        std::size_t              total = 0;
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            if (blocks[i].offset > data.size() || data.size() - blocks[i].offset < blocks[i].compressedSize)
+                throw std::runtime_error("Compressed asset block is out of bounds");
+            outputOffsets[i] = total;
+            total += blocks[i].uncompressedSize;
+        }
+        if (total != header.uncompressedSize)
+            throw std::runtime_error("Compressed asset blocks don't add up to the declared size");
+
+        std::vector<unsigned char> output(total);
+        const auto                 decodeBlock = [&](const std::size_t i) {
+            inflate(data.subspan(blocks[i].offset, blocks[i].compressedSize), std::span(output).subspan(outputOffsets[i], blocks[i].uncompressedSize));
+        };
+
+        // blocks are spread over the load pool, the calling thread decodes its share while it waits (on a pool worker too)
+        if (AssetLoadPool *pool = AssetLoadPool::current(); pool && blocks.size() > 1) {
+            pool->parallelFor(blocks.size(), decodeBlock);
+        } else {
+            for (std::size_t i = 0; i < blocks.size(); ++i) {
+                decodeBlock(i);
+            }
+        }
+        return output;
+    }
+} // namespace game
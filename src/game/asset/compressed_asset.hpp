@@ -0,0 +1,51 @@
+//
+// Created by andy on 6/24/2025.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace game {
+    /**
+     * @brief Header of a compressed asset (all values little-endian).
+     *
+     * A compressed asset is split into blocks which are each compressed as an independent raw DEFLATE stream, so the blocks can be decompressed in parallel. The header is
+     * followed by blockCount block descriptors and then the compressed blocks.
+     */
+    struct CompressedAssetHeader {
+        static constexpr uint32_t MAGIC   = 0x5A434754; // "TGCZ"
+        static constexpr uint32_t VERSION = 1;
+
+        uint32_t magic;
+        uint32_t version;
+        uint32_t blockCount;
+        uint32_t blockSize; // uncompressed size of every block but the last (informational)
+        uint64_t uncompressedSize;
+    };
+
+    static_assert(sizeof(CompressedAssetHeader) == 24);
+
+    struct CompressedAssetBlock {
+        uint64_t offset; // from the start of the compressed asset
+        uint32_t compressedSize;
+        uint32_t uncompressedSize;
+    };
+
+    static_assert(sizeof(CompressedAssetBlock) == 16);
+
+    /**
+     * @return If the data is a compressed asset (checks the magic number).
+     */
+    bool isCompressedAsset(std::span<const unsigned char> data) noexcept;
+
+    /**
+     * @brief Decompress a compressed asset. Blocks are decompressed in parallel on the AssetLoadPool (see AssetLoadPool::current) when there is more than one.
+     * @param data The compressed asset
+     * @return The decompressed contents
+     * @throws std::runtime_error if the data is malformed
+     */
+    std::vector<unsigned char> decompressAsset(std::span<const unsigned char> data);
+} // namespace game
@@ -0,0 +1,108 @@
+//
+// Created by andy on 6/22/2025.
+//
+
+#include "mapped_file.hpp"
+
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+namespace game {
+#if defined(__unix__) || defined(__APPLE__)
+    MappedFile::MappedFile(const std::filesystem::path &path) {
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw std::invalid_argument("Couldn't open file: " + path.string());
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::invalid_argument("Couldn't stat file: " + path.string());
+        }
+
+        m_Size = static_cast<std::size_t>(st.st_size);
+        if (m_Size > 0) { // mmap rejects empty mappings, and an empty span is fine for empty files
+            void *mapping = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                close(fd);
+                throw std::invalid_argument("Couldn't map file: " + path.string());
+            }
+
+            madvise(mapping, m_Size, MADV_SEQUENTIAL); // loaders read front to back
+            m_Data = static_cast<const unsigned char *>(mapping);
+        }
+
+        close(fd); // the mapping keeps its own reference to the file
+    }
+
+    void MappedFile::release() noexcept {
+        if (m_Data != nullptr) {
+            munmap(const_cast<unsigned char *>(m_Data), m_Size);
+        }
+        m_Data = nullptr;
+        m_Size = 0;
+    }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept : m_Data(other.m_Data), m_Size(other.m_Size) {
+        other.m_Data = nullptr;
+        other.m_Size = 0;
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+        if (this == &other)
+            return *this;
+        release();
+        m_Data       = other.m_Data;
+        m_Size       = other.m_Size;
+        other.m_Data = nullptr;
+        other.m_Size = 0;
+        return *this;
+    }
+#else
+    MappedFile::MappedFile(const std::filesystem::path &path) {
+        std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+        if (file.rdstate() != std::ios_base::goodbit)
+            throw std::invalid_argument("Couldn't open file: " + path.string());
+
+        m_Buffer.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0, std::ios::beg);
+        file.read(reinterpret_cast<char *>(m_Buffer.data()), static_cast<std::streamsize>(m_Buffer.size()));
+        m_Data = m_Buffer.data();
+        m_Size = m_Buffer.size();
+    }
+
+    void MappedFile::release() noexcept {
+        m_Buffer.clear();
+        m_Data = nullptr;
+        m_Size = 0;
+    }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept : m_Data(other.m_Data), m_Size(other.m_Size), m_Buffer(std::move(other.m_Buffer)) {
+        other.m_Data = nullptr;
+        other.m_Size = 0;
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+        if (this == &other)
+            return *this;
+        m_Buffer     = std::move(other.m_Buffer);
+        m_Data       = other.m_Data;
+        m_Size       = other.m_Size;
+        other.m_Data = nullptr;
+        other.m_Size = 0;
+        return *this;
+    }
+#endif
+
+    MappedFile::~MappedFile() {
+        release();
+    }
+} // namespace game
@@ -0,0 +1,47 @@
+//
+// Created by andy on 6/22/2025.
+//
+
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace game {
+    /**
+     * @brief A read-only memory mapping of a file.
+     *
+     * The mapping lives exactly as long as this object, so any span handed out by data() must not outlive it. On platforms without mmap support the file is read into an owned
+     * buffer instead (the interface is identical).
+     */
+    class MappedFile {
+      public:
+        /**
+         * @brief Map a file
+         * @param path The full path to the file
+         */
+        explicit MappedFile(const std::filesystem::path &path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile &other)            = delete;
+        MappedFile &operator=(const MappedFile &other) = delete;
+
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+
+        [[nodiscard]] inline std::span<const unsigned char> data() const noexcept { return {m_Data, m_Size}; }
+
+        [[nodiscard]] inline std::size_t size() const noexcept { return m_Size; }
+
+      private:
+        const unsigned char *m_Data = nullptr;
+        std::size_t          m_Size = 0;
+
+#if !defined(__unix__) && !defined(__APPLE__)
+        std::vector<unsigned char> m_Buffer; // fallback storage when we can't map the file
+#endif
+
+        void release() noexcept;
+    };
+} // namespace game
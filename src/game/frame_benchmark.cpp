@@ -0,0 +1,70 @@
+//
+// Created by andy on 7/10/2025.
+//
+
+#include "frame_benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+namespace game {
+    FrameBenchmark::FrameBenchmark(const uint64_t frames) : m_Frames(frames) {
+        m_Frame.reserve(frames);
+        m_Cpu.reserve(frames);
+        m_Submit.reserve(frames);
+        m_FenceWait.reserve(frames);
+    }
+
+    void FrameBenchmark::record(const std::chrono::nanoseconds frame, const std::chrono::nanoseconds submit, const std::chrono::nanoseconds fenceWait) {
+        if (finished() || m_Rendered++ < WARMUP_FRAMES)
+            return;
+
+        m_Frame.push_back(frame.count());
+        m_Cpu.push_back(std::max<int64_t>((frame - fenceWait).count(), 0));
+        m_Submit.push_back(submit.count());
+        m_FenceWait.push_back(fenceWait.count());
+    }
+
+    static nlohmann::json summarize(std::vector<int64_t> samples) {
+        const auto micros = [](const int64_t nanoseconds) { return static_cast<double>(nanoseconds) / 1000.0; };
+        if (samples.empty())
+            return {{"p50_us", 0.0}, {"p95_us", 0.0}, {"p99_us", 0.0}, {"max_us", 0.0}, {"mean_us", 0.0}};
+
+        std::ranges::sort(samples);
+        // nearest rank, so every reported value is a frame that actually happened
+        const auto percentile = [&](const double p) {
+            const auto rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(samples.size())));
+            return micros(samples[std::clamp<std::size_t>(rank, 1, samples.size()) - 1]);
+        };
+        const auto total = std::accumulate(samples.begin(), samples.end(), int64_t{0});
+        return {
+            {"p50_us", percentile(0.5)},
+            {"p95_us", percentile(0.95)},
+            {"p99_us", percentile(0.99)},
+            {"max_us", micros(samples.back())},
+            {"mean_us", micros(total) / static_cast<double>(samples.size())},
+        };
+    }
+
+    nlohmann::json FrameBenchmark::toJson() const {
+        return {
+            {"frames", m_Frame.size()},
+            {"warmup_frames", WARMUP_FRAMES},
+            {"step_seconds", STEP},
+            {"frame_time", summarize(m_Frame)},
+            {"cpu_time", summarize(m_Cpu)},
+            {"submit_time", summarize(m_Submit)},
+            {"fence_wait_time", summarize(m_FenceWait)},
+        };
+    }
+
+    void FrameBenchmark::save(const std::filesystem::path &path) const {
+        std::ofstream out(path, std::ios::trunc);
+        out << toJson().dump(4) << '\n';
+        if (!out)
+            throw std::runtime_error("Failed to write frame benchmark '" + path.string() + "'");
+    }
+} // namespace game
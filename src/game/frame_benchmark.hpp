@@ -0,0 +1,64 @@
+//
+// Created by andy on 7/10/2025.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+namespace game {
+    /**
+     * @brief Drives a --benchmark run: a fixed number of frames of the same scene on a simulated clock, timed so renderer changes can be compared run to run.
+     *
+     * The clock advances by exactly STEP every frame instead of following the wall clock, so every run renders the same frames no matter how fast it goes. The first
+     * WARMUP_FRAMES aren't recorded (pipelines, caches and the driver are still settling). Every sample is kept, so the percentiles are exact rather than bucketed like
+     * LatencyHistogram's.
+     */
+    class FrameBenchmark {
+      public:
+        static constexpr double   STEP          = 1.0 / 60.0; // seconds of simulated time per frame
+        static constexpr uint64_t WARMUP_FRAMES = 30;
+
+        /**
+         * @param frames How many frames to record (after the warmup)
+         */
+        explicit FrameBenchmark(uint64_t frames);
+
+        /**
+         * @return The simulated time of the frame about to be rendered, in seconds
+         */
+        [[nodiscard]] inline double time() const noexcept { return static_cast<double>(m_Rendered) * STEP; }
+
+        /**
+         * @brief Records a rendered frame and advances the clock.
+         * @param frame The whole frame, from the start of the main loop iteration to its end
+         * @param submit The time spent submitting the frame's command buffer
+         * @param fenceWait The time spent waiting for the GPU to finish the frame that last used this frame's resources
+         */
+        void record(std::chrono::nanoseconds frame, std::chrono::nanoseconds submit, std::chrono::nanoseconds fenceWait);
+
+        [[nodiscard]] inline bool finished() const noexcept { return m_Rendered >= WARMUP_FRAMES + m_Frames; }
+
+        /**
+         * @return The frame count, the simulated step and p50, p95, p99, max and mean (in microseconds) of the frame time, the CPU frame time (the frame without the fence
+         * wait), the submit time and the fence wait time
+         */
+        [[nodiscard]] nlohmann::json toJson() const;
+
+        void save(const std::filesystem::path &path) const;
+
+      private:
+        uint64_t m_Frames;
+        uint64_t m_Rendered = 0; // including the warmup
+
+        // nanoseconds, one per recorded frame
+        std::vector<int64_t> m_Frame;
+        std::vector<int64_t> m_Cpu;
+        std::vector<int64_t> m_Submit;
+        std::vector<int64_t> m_FenceWait;
+    };
+} // namespace game
@@ -1,49 +1,86 @@
 #include "game/game.hpp"
 
 #include "game/asset/asset_manager.hpp"
+#include "game/profiler.hpp"
+#include "spdlog/spdlog.h"
 
+#include <charconv>
 #include <iostream>
+#include <stdexcept>
+#include <string_view>
 
 namespace game {
-    libload::libload() {
-        glfwInit();
+    libload::libload(const bool headless) : m_Initialized(!headless) {
+        if (m_Initialized && glfwInit() != GLFW_TRUE)
+            throw std::runtime_error("Failed to initialize glfw");
     }
 
     libload::~libload() {
-        glfwTerminate();
+        if (m_Initialized)
+            glfwTerminate();
     }
 
-    Game::Game() {
-        m_Window        = std::make_shared<Window>();
-        m_RenderDevice  = std::make_shared<RenderDevice>();
-        m_RenderSurface = std::make_shared<RenderSurface>(m_Window, m_RenderDevice);
+    Game::Game(const GameOptions &options) : m_Options(options), _libload(options.headless) {
+        // start warming the page cache with what the last run read before anything else, so it overlaps with creating the window and the device
+        m_Prefetcher = std::make_unique<AssetPrefetcher>(assetPath("access.trace"));
+        beginAccessTrace(assetPath("access.trace"));
+
+        m_RenderDevice = std::make_shared<RenderDevice>(m_Options.headless);
+        if (m_Options.headless) {
+            m_RenderSurface = std::make_shared<OffscreenRenderSurface>(m_RenderDevice, m_Options.extent);
+        } else {
+            m_Window        = std::make_shared<Window>();
+            m_RenderSurface = std::make_shared<SwapchainRenderSurface>(m_Window, m_RenderDevice);
+        }
         m_RenderSystem  = std::make_shared<RenderSystem>(m_RenderDevice, m_RenderSurface);
         m_FrameManager  = std::make_shared<FrameManager<FrameResources, ImageResources>>(m_RenderSystem, &FrameResources::create, &ImageResources::create);
         m_AssetManager  = std::make_shared<AssetManager>(m_RenderSystem);
+        m_AssetManager->setResidencyBudget(RESIDENCY_BUDGET);
+
+        if (const auto pack = assetPath("assets.pack"); std::filesystem::exists(pack)) {
+            mountAssetPack(pack);
+        }
+        if (const auto database = assetPath("assets.db"); std::filesystem::exists(database)) {
+            openAssetDatabase(database);
+        }
+        openMetadataCache(assetPath("metadata.cache"));
+
+        if (m_Options.benchmarkFrames != 0) {
+            m_Benchmark = std::make_unique<FrameBenchmark>(m_Options.benchmarkFrames);
+        }
+
+#ifndef GAME_BUILD_DIST
+        // not while benchmarking, an asset changing halfway would make the run incomparable
+        if (!m_Benchmark)
+            m_HotReloader = std::make_unique<AssetHotReloader>(m_AssetManager, FrameManager<FrameResources, ImageResources>::MAX_FRAMES_IN_FLIGHT);
+#endif
 
         m_Bundle = m_AssetManager->loadFromFile<AssetBundleLoader>("simple_bundle.json");
 
         m_Shader         = m_AssetManager->get<Shader>("shaders/sample_linked_shader.json");
         m_PipelineLayout = m_AssetManager->get<PipelineLayout>("render/sample_pipeline_layout.json");
 
-        glfwSetWindowUserPointer(m_Window->window(), this);
+        if (m_Window) {
+            glfwSetWindowUserPointer(m_Window->window(), this);
 
-        glfwSetWindowRefreshCallback(
-            m_Window->window(),
-            +[](GLFWwindow *window) {
-                auto *game = static_cast<Game *>(glfwGetWindowUserPointer(window));
-                game->frame();
-            }
-        );
+            glfwSetWindowRefreshCallback(
+                m_Window->window(),
+                +[](GLFWwindow *window) {
+                    auto *game = static_cast<Game *>(glfwGetWindowUserPointer(window));
+                    game->frame();
+                }
+            );
+        }
     }
 
     Game::~Game() = default;
 
     void Game::frame() {
-        if (glfwGetWindowAttrib(m_Window->window(), GLFW_ICONIFIED))
+        GAME_PROFILE_ZONE("Game::frame");
+        if (m_Window && glfwGetWindowAttrib(m_Window->window(), GLFW_ICONIFIED))
             return;
 
-        if (const auto extent = m_Window->getExtent(); extent.width > 0 && extent.height > 0) {
+        if (const auto extent = m_Window ? m_Window->getExtent() : m_Options.extent; extent.width > 0 && extent.height > 0) {
             m_FrameManager->renderFrame([&](const vk::raii::CommandBuffer &cmd, const FrameResources &frameResources, const ImageResources &imageResources,
                                             const ImageProperties &imageProperties, const vk::Image image) { render(cmd, frameResources, imageResources, imageProperties, image); }
             );
@@ -51,29 +88,88 @@ namespace game {
     }
 
     void Game::run() {
+        GAME_PROFILE_THREAD("main");
         m_AssetManager->beginDeletionThread();
+        DeferredAssetRefs deferredRefs; // rendering copies and drops references all frame, so the main thread releases them once a frame before the gc cycle
 
-        int frames = 0;
+        while (!shouldStop()) {
+            GAME_PROFILE_ZONE("Game::run");
+            const auto start     = std::chrono::steady_clock::now();
+            const auto submitted = m_FrameManager->framesSubmitted();
 
-        while (!m_Window->shouldClose()) {
-            glfwPollEvents();
+            if (m_Window) {
+                GAME_PROFILE_ZONE("poll events");
+                glfwPollEvents();
+            }
+            if (m_HotReloader) {
+                GAME_PROFILE_ZONE("hot reload");
+                m_HotReloader->poll(m_FrameManager->framesSubmitted());
+            }
+            {
+                GAME_PROFILE_ZONE("stream finalize");
+                m_AssetManager->streamQueue().finalize(STREAM_BUDGET);
+            }
+            deferredRefs.flush();
             m_AssetManager->startDeletionCycle();
             frame();
             m_AssetManager->deleteWaitingAssets();
 
-            if (frames < 20000) {
-                if (++frames == 20000) {
-//                    m_UnlinkedShaderFrag.reset();
-//                    m_UnlinkedShaderVert.reset();
-                    std::cout << "trigger" << std::endl;
-                }
+            // a minimized window skips the frame, which isn't one to time or to move the clock past
+            if (m_Benchmark && m_FrameManager->framesSubmitted() != submitted) {
+                const auto &timings = m_FrameManager->lastFrameTimings();
+                m_Benchmark->record(std::chrono::steady_clock::now() - start, timings.submit, timings.fenceWait);
             }
         }
+        deferredRefs.flush();
 
         // request the thread to stop, then wait for the vulkan device to be idle, then join the deletion thread (no reason these two need to be sequenced so we just do this).
         m_AssetManager->endDeletionThread();
         m_RenderDevice->device().waitIdle();
         m_AssetManager->finalEndDeletionThread();
+
+        saveMetadataCache(); // so the next launch can skip parsing whatever metadata this one parsed
+        saveAccessTrace();   // and prefetch whatever this one read
+
+#ifndef GAME_BUILD_DIST
+        try {
+            m_AssetManager->telemetry().save("asset_telemetry.json");
+        } catch (const std::exception &e) {
+            spdlog::warn("Couldn't save asset telemetry: {}", e.what());
+        }
+#endif
+
+        if (m_Benchmark) {
+            try {
+                m_Benchmark->save(m_Options.benchmarkOutput);
+                spdlog::info("Saved frame timings to {}", m_Options.benchmarkOutput.string());
+            } catch (const std::exception &e) {
+                spdlog::error("Couldn't save frame timings: {}", e.what());
+            }
+        }
+
+#ifdef TILEGAME_PROFILING
+        try {
+            profiler::saveChromeTrace("profile.json");
+        } catch (const std::exception &e) {
+            spdlog::warn("Couldn't save profile: {}", e.what());
+        }
+#endif
+    }
+
+    bool Game::shouldStop() const {
+        if (m_Benchmark && m_Benchmark->finished())
+            return true;
+        if (m_Options.frameLimit != 0 && m_FrameManager->framesSubmitted() >= m_Options.frameLimit)
+            return true;
+        return m_Window && m_Window->shouldClose();
+    }
+
+    double Game::time() const {
+        if (m_Benchmark)
+            return m_Benchmark->time();
+        if (m_Window)
+            return glfwGetTime();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_StartTime).count(); // glfw isn't initialized headless
     }
 
     void Game::render(
@@ -191,8 +287,8 @@ namespace game {
     void Game::renderPass(
         const vk::raii::CommandBuffer &cmd, const FrameResources &frameResources, const ImageResources &imageResources, const ImageProperties &imageProperties, vk::Image image
     ) {
-        double t = glfwGetTime();
-        PC     pc{};
+        const double t = time();
+        PC           pc{};
         pc.x    = 0.25 * cos(t);
         pc.y    = 0.25 * sin(t);
         pc.time = t;
@@ -204,8 +300,49 @@ namespace game {
     }
 } // namespace game
 
-int main() {
-    const auto game = std::make_unique<game::Game>();
+namespace {
+    constexpr std::string_view USAGE = "usage: tilegame [--headless] [--frames count] [--benchmark frames [--benchmark-output file]]";
+
+    /**
+     * @brief parses a whole command line argument as a frame count
+     * @return false if the argument isn't entirely a non negative number
+     */
+    bool parseCount(const std::string_view arg, uint64_t &count) {
+        const auto [end, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), count);
+        return ec == std::errc{} && end == arg.data() + arg.size();
+    }
+} // namespace
+
+int main(const int argc, char **argv) {
+    game::GameOptions options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        bool                   valid = true;
+        if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--frames" && i + 1 < argc) {
+            valid = parseCount(argv[++i], options.frameLimit);
+        } else if (arg == "--benchmark" && i + 1 < argc) {
+            valid = parseCount(argv[++i], options.benchmarkFrames);
+        } else if (arg == "--benchmark-output" && i + 1 < argc) {
+            options.benchmarkOutput = argv[++i];
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            std::cerr << USAGE << std::endl;
+            return 1;
+        }
+    }
+
+    // there's no window to close, so a headless run needs something else to end it
+    if (options.headless && options.frameLimit == 0 && options.benchmarkFrames == 0) {
+        std::cerr << "--headless needs --frames or --benchmark" << std::endl;
+        std::cerr << USAGE << std::endl;
+        return 1;
+    }
+
+    const auto game = std::make_unique<game::Game>(options);
     game->run();
     return 0;
 }
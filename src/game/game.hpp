@@ -1,19 +1,33 @@
 #pragma once
 
 #include <GLFW/glfw3.h>
+#include <chrono>
 #include <memory>
 
+#include "game/asset/asset_access_trace.hpp"
 #include "game/asset/asset_bundle.hpp"
+#include "game/asset/asset_hot_reload.hpp"
+#include "game/frame_benchmark.hpp"
 #include "game/render/frame_manager.hpp"
+#include "game/render/offscreen_render_surface.hpp"
 #include "game/render/pipeline_layout.hpp"
 #include "game/render/render_system.hpp"
 #include "game/render/shader_object.hpp"
 #include "game/window.hpp"
 
 namespace game {
+    /**
+     * @brief Initializes glfw for the game's lifetime. Headless games skip it, so they don't need a display.
+     */
     struct libload {
-        libload();
+        explicit libload(bool headless);
         ~libload();
+
+        libload(const libload &other)            = delete;
+        libload &operator=(const libload &other) = delete;
+
+      private:
+        bool m_Initialized;
     };
 
     struct FrameResources {
@@ -35,9 +49,21 @@ namespace game {
         }
     };
 
+    /**
+     * @brief How to run the game (set from the command line)
+     */
+    struct GameOptions {
+        bool         headless   = false;      // render into offscreen images instead of a window (see OffscreenRenderSurface)
+        vk::Extent2D extent     = {800, 600}; // the size of the offscreen images
+        uint64_t     frameLimit = 0;          // stop after rendering this many frames, 0 runs until the window is closed
+
+        uint64_t              benchmarkFrames = 0;                // render this many frames on a simulated clock and save their timings, 0 doesn't benchmark (see FrameBenchmark)
+        std::filesystem::path benchmarkOutput = "benchmark.json"; // where the timings are saved
+    };
+
     class Game {
       public:
-        Game();
+        explicit Game(const GameOptions &options = {});
         ~Game();
 
         void frame();
@@ -52,13 +78,35 @@ namespace game {
         );
 
       private:
-        libload                                                       _libload{};
-        std::shared_ptr<Window>                                       m_Window;
+        /**
+         * @brief How long streaming may spend finalizing loads each frame (see AssetStreamQueue::finalize)
+         */
+        static constexpr std::chrono::microseconds STREAM_BUDGET{2000};
+
+        /**
+         * @brief How many bytes of unreferenced assets to keep resident, so going back to an area doesn't reload everything (see AssetManager::setResidencyBudget)
+         */
+        static constexpr std::size_t RESIDENCY_BUDGET = 256 * 1024 * 1024;
+
+        [[nodiscard]] bool shouldStop() const;
+
+        /**
+         * @return The time the scene is rendered at in seconds, simulated when benchmarking (glfw's clock with a window, otherwise the time since the game started)
+         */
+        [[nodiscard]] double time() const;
+
+        GameOptions                                                   m_Options;
+        std::chrono::steady_clock::time_point                         m_StartTime = std::chrono::steady_clock::now(); // the clock of runs without a window
+        libload                                                       _libload;
+        std::unique_ptr<AssetPrefetcher>                              m_Prefetcher; // replays the last run's reads while the renderer starts up
+        std::shared_ptr<Window>                                       m_Window; // not created headless
         std::shared_ptr<RenderDevice>                                 m_RenderDevice;
         std::shared_ptr<RenderSurface>                                m_RenderSurface;
         std::shared_ptr<RenderSystem>                                 m_RenderSystem;
         std::shared_ptr<FrameManager<FrameResources, ImageResources>> m_FrameManager;
         std::shared_ptr<AssetManager>                                 m_AssetManager;
+        std::unique_ptr<AssetHotReloader>                             m_HotReloader; // only in development builds, dist builds don't ship loose assets
+        std::unique_ptr<FrameBenchmark>                               m_Benchmark;   // only with --benchmark
 
         AssetRef<AssetBundle> m_Bundle;
 
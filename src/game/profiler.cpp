@@ -0,0 +1,150 @@
+//
+// Created by andy on 7/7/2025.
+//
+
+#include "profiler.hpp"
+
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <vector>
+
+namespace game {
+    namespace profiler {
+        namespace {
+            struct ZoneEvent {
+                const char *name;
+                int64_t     start; // nanoseconds since s_Epoch
+                int64_t     end;
+            };
+
+            constexpr std::size_t BLOCK_EVENTS = 4096;
+
+            // a thread stops recording past this many zones (about 100MB), so a profiling build left running can't eat all the memory
+            constexpr std::size_t MAX_THREAD_EVENTS = std::size_t{1} << 22;
+
+            /**
+             * @brief A single thread's zones. Only the owning thread appends, readers see everything up to the published counts.
+             */
+            struct ThreadBuffer {
+                struct Block {
+                    std::array<ZoneEvent, BLOCK_EVENTS> events;
+                    std::atomic<std::size_t>            count = 0;
+                    std::atomic<Block *>                next  = nullptr;
+                };
+
+                uint32_t    id;
+                std::string name; // guarded by s_BuffersMutex
+                Block      *first;
+                Block      *last;
+                std::size_t total = 0; // owner only
+
+                explicit ThreadBuffer(const uint32_t id) : id(id), first(new Block()), last(first) {}
+
+                ~ThreadBuffer() {
+                    for (Block *block = first; block != nullptr;) {
+                        Block *next = block->next.load(std::memory_order::relaxed);
+                        delete block;
+                        block = next;
+                    }
+                }
+
+                ThreadBuffer(const ThreadBuffer &other)            = delete;
+                ThreadBuffer &operator=(const ThreadBuffer &other) = delete;
+
+                void append(const ZoneEvent &event) {
+                    if (total >= MAX_THREAD_EVENTS)
+                        return;
+
+                    auto count = last->count.load(std::memory_order::relaxed);
+                    if (count == BLOCK_EVENTS) {
+                        auto *block = new Block();
+                        last->next.store(block, std::memory_order::release);
+                        last  = block;
+                        count = 0;
+                    }
+                    last->events[count] = event;
+                    last->count.store(count + 1, std::memory_order::release);
+                    total++;
+                }
+            };
+
+            const auto s_Epoch = std::chrono::steady_clock::now();
+
+            std::mutex                                 s_BuffersMutex;
+            std::vector<std::shared_ptr<ThreadBuffer>> s_Buffers; // every thread that recorded something, in order of their first zone
+
+            ThreadBuffer &currentBuffer() {
+                // shared with s_Buffers, so the buffer outlives the thread and the thread can't outlive the buffer during static destruction
+                thread_local std::shared_ptr<ThreadBuffer> t_Buffer = [] {
+                    std::lock_guard lock(s_BuffersMutex);
+                    return s_Buffers.emplace_back(std::make_shared<ThreadBuffer>(static_cast<uint32_t>(s_Buffers.size() + 1)));
+                }();
+                return *t_Buffer;
+            }
+
+            int64_t sinceEpoch(const std::chrono::steady_clock::time_point time) {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(time - s_Epoch).count();
+            }
+        } // namespace
+
+        Zone::~Zone() {
+            currentBuffer().append({m_Name, sinceEpoch(m_Start), sinceEpoch(std::chrono::steady_clock::now())});
+        }
+
+        void setThreadName(std::string name) {
+            auto           &buffer = currentBuffer();
+            std::lock_guard lock(s_BuffersMutex);
+            buffer.name = std::move(name);
+        }
+
+        std::size_t zoneCount() {
+            std::lock_guard lock(s_BuffersMutex);
+            std::size_t     count = 0;
+            for (const auto &buffer : s_Buffers) {
+                for (const auto *block = buffer->first; block != nullptr; block = block->next.load(std::memory_order::acquire)) {
+                    count += block->count.load(std::memory_order::acquire);
+                }
+            }
+            return count;
+        }
+
+        void saveChromeTrace(const std::filesystem::path &path) {
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+            std::vector<std::string>                   names;
+            {
+                std::lock_guard lock(s_BuffersMutex);
+                buffers = s_Buffers;
+                for (const auto &buffer : buffers) {
+                    names.push_back(buffer->name.empty() ? "thread " + std::to_string(buffer->id) : buffer->name);
+                }
+            }
+
+            std::ofstream out(path, std::ios::trunc);
+            out << std::fixed << std::setprecision(3); // timestamps are in microseconds, this keeps them to the nanosecond
+            out << R"({"displayTimeUnit":"ms","traceEvents":[)";
+            for (std::size_t i = 0; i < buffers.size(); i++) {
+                const auto tid = buffers[i]->id;
+                out << (i == 0 ? "\n" : ",\n") << R"({"ph":"M","name":"thread_name","pid":1,"tid":)" << tid << R"(,"args":{"name":)" << nlohmann::json(names[i]).dump() << "}}";
+
+                for (const auto *block = buffers[i]->first; block != nullptr; block = block->next.load(std::memory_order::acquire)) {
+                    const auto count = block->count.load(std::memory_order::acquire);
+                    for (std::size_t e = 0; e < count; e++) {
+                        // complete events, nesting is worked out by the viewer from the times
+                        const auto &event = block->events[e];
+                        out << ",\n" << R"({"ph":"X","name":)" << nlohmann::json(event.name).dump() << R"(,"pid":1,"tid":)" << tid << R"(,"ts":)"
+                            << static_cast<double>(event.start) / 1000.0 << R"(,"dur":)" << static_cast<double>(event.end - event.start) / 1000.0 << "}";
+                    }
+                }
+            }
+            out << "\n]}\n";
+            if (!out)
+                throw std::runtime_error("Failed to write profile '" + path.string() + "'");
+        }
+    } // namespace profiler
+} // namespace game
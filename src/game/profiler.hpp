@@ -0,0 +1,78 @@
+//
+// Created by andy on 7/7/2025.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace game {
+    /**
+     * @brief A scoped-zone CPU profiler which exports Chrome trace events (load the file in chrome://tracing or https://ui.perfetto.dev).
+     *
+     * Each thread records finished zones into its own buffer of fixed-size blocks, which only that thread writes to, so recording a zone takes no locks (a lock is only taken
+     * the first time a thread records anything). Buffers are kept until the program exits, so threads that have finished still show up in the trace.
+     *
+     * Zones are placed with GAME_PROFILE_ZONE, which compiles to nothing unless TILEGAME_PROFILING is defined (the TILEGAME_PROFILING cmake option).
+     */
+    namespace profiler {
+        /**
+         * @brief Records the time between its construction and destruction as a zone on the current thread.
+         */
+        class Zone {
+          public:
+            /**
+             * @param name The zone's name (must live for the rest of the program, use a string literal)
+             */
+            inline explicit Zone(const char *name) noexcept : m_Name(name), m_Start(std::chrono::steady_clock::now()) {}
+
+            ~Zone();
+
+            Zone(const Zone &other)                = delete;
+            Zone(Zone &&other) noexcept            = delete;
+            Zone &operator=(const Zone &other)     = delete;
+            Zone &operator=(Zone &&other) noexcept = delete;
+
+          private:
+            const char                           *m_Name;
+            std::chrono::steady_clock::time_point m_Start;
+        };
+
+        /**
+         * @brief Name the current thread in the trace (threads that aren't named show up by number)
+         */
+        void setThreadName(std::string name);
+
+        /**
+         * @return The number of zones recorded so far, on every thread
+         */
+        [[nodiscard]] std::size_t zoneCount();
+
+        /**
+         * @brief Write every zone recorded so far as a Chrome trace-event json file. Threads may keep recording while this runs, zones finished after it started may be left out.
+         * @throws std::runtime_error if the file can't be written
+         */
+        void saveChromeTrace(const std::filesystem::path &path);
+    } // namespace profiler
+} // namespace game
+
+#ifdef TILEGAME_PROFILING
+#define GAME_PROFILE_CONCAT_INNER(a, b) a##b
+#define GAME_PROFILE_CONCAT(a, b)       GAME_PROFILE_CONCAT_INNER(a, b)
+
+/**
+ * @brief Profile the rest of the enclosing scope as a zone (name must be a string literal)
+ */
+#define GAME_PROFILE_ZONE(name) const ::game::profiler::Zone GAME_PROFILE_CONCAT(profileZone_, __LINE__)(name)
+
+/**
+ * @brief Name the current thread in the trace
+ */
+#define GAME_PROFILE_THREAD(name) ::game::profiler::setThreadName(name)
+#else
+#define GAME_PROFILE_ZONE(name)   ((void) 0)
+#define GAME_PROFILE_THREAD(name) ((void) 0)
+#endif
@@ -4,10 +4,12 @@
 
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <vulkan/vulkan_raii.hpp>
 
+#include "game/profiler.hpp"
 #include "game/utils.hpp"
 #include "game/render/render.hpp"
 #include "game/render/render_system.hpp"
@@ -24,6 +26,17 @@ namespace game {
               renderFinishedSemaphore(renderSystem->renderDevice()->device(), vk::SemaphoreCreateInfo()) {}
     };
 
+    /**
+     * @brief Where the CPU time of a frame went, as measured by FrameManager::renderFrame
+     */
+    struct FrameTimings {
+        std::chrono::nanoseconds fenceWait{0}; // waiting for the frame that last used this frame's resources to finish on the GPU
+        std::chrono::nanoseconds acquire{0};
+        std::chrono::nanoseconds record{0};
+        std::chrono::nanoseconds submit{0};
+        std::chrono::nanoseconds present{0};
+    };
+
     /**
      * @brief Utility to manage frames
      * @tparam F Frame based resource type. This is good for things like descriptor sets.
@@ -60,13 +73,32 @@ namespace game {
         }
 
         void renderFrame(const std::function<void(const vk::raii::CommandBuffer &, const F &, const I &, const ImageProperties &, vk::Image)> &f) {
+            GAME_PROFILE_ZONE("FrameManager::renderFrame");
             if (m_RenderSystem->checkRebuildSwapchain()) {
+                GAME_PROFILE_ZONE("rebuild swapchain");
                 generateImageResources();
             }
 
-            const auto           &fso = m_FrameSyncObjects[m_CurrentFrame];
-            [[maybe_unused]] auto _   = m_RenderSystem->renderDevice()->device().waitForFences(*fso.inFlightFence, true, UINT64_MAX);
-            if (const auto curImage = m_RenderSystem->renderSurface()->acquireNextImage(fso.imageAvailableSemaphore); curImage.has_value()) {
+            const auto &fso   = m_FrameSyncObjects[m_CurrentFrame];
+            auto        start = std::chrono::steady_clock::now();
+            const auto  lap   = [&start] {
+                const auto now     = std::chrono::steady_clock::now();
+                const auto elapsed = now - start;
+                start              = now;
+                return elapsed;
+            };
+
+            {
+                GAME_PROFILE_ZONE("wait for frame fence");
+                [[maybe_unused]] auto _ = m_RenderSystem->renderDevice()->device().waitForFences(*fso.inFlightFence, true, UINT64_MAX);
+            }
+            m_LastTimings.fenceWait = lap();
+            const auto curImage     = [&] {
+                GAME_PROFILE_ZONE("acquire image");
+                return m_RenderSystem->renderSurface()->acquireNextImage(fso.imageAvailableSemaphore);
+            }();
+            m_LastTimings.acquire = lap();
+            if (curImage.has_value()) {
                 m_RenderSystem->renderDevice()->device().resetFences(*fso.inFlightFence);
                 const auto &[image, index] = curImage.value();
                 m_CurrentImageIndex        = index;
@@ -74,10 +106,14 @@ namespace game {
                 ImageProperties imageProperties{m_RenderSystem->renderSurface()->format(), m_RenderSystem->renderSurface()->extent()};
 
                 const auto &cmd = m_CommandBuffers[m_CurrentFrame];
-                cmd.reset();
-                cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
-                f(cmd, m_FrameResources[m_CurrentFrame], m_ImageResources[m_CurrentImageIndex], imageProperties, image);
-                cmd.end();
+                {
+                    GAME_PROFILE_ZONE("record");
+                    cmd.reset();
+                    cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+                    f(cmd, m_FrameResources[m_CurrentFrame], m_ImageResources[m_CurrentImageIndex], imageProperties, image);
+                    cmd.end();
+                }
+                m_LastTimings.record = lap();
 
                 constexpr vk::PipelineStageFlags mask = vk::PipelineStageFlagBits::eTopOfPipe;
 
@@ -86,14 +122,33 @@ namespace game {
                 submitInfo.setWaitSemaphores(*fso.imageAvailableSemaphore);
                 submitInfo.setSignalSemaphores(*fso.renderFinishedSemaphore);
                 submitInfo.setWaitDstStageMask(mask);
-                m_RenderSystem->renderDevice()->mainQueue().submit(submitInfo, fso.inFlightFence);
-
-                m_RenderSystem->renderSurface()->present(index, fso.renderFinishedSemaphore);
+                {
+                    GAME_PROFILE_ZONE("submit");
+                    m_RenderSystem->renderDevice()->mainQueue().submit(submitInfo, fso.inFlightFence);
+                }
+                m_LastTimings.submit = lap();
+                m_FramesSubmitted++;
+
+                {
+                    GAME_PROFILE_ZONE("present");
+                    m_RenderSystem->renderSurface()->present(index, fso.renderFinishedSemaphore);
+                }
+                m_LastTimings.present = lap();
 
                 m_CurrentFrame = (m_CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
             }
         }
 
+        /**
+         * @return The number of frames submitted so far. Frame n (counting from 0) has finished on the GPU once this exceeds n + MAX_FRAMES_IN_FLIGHT, since that frame waited on frame n's fence before it was submitted.
+         */
+        [[nodiscard]] uint64_t framesSubmitted() const noexcept { return m_FramesSubmitted; }
+
+        /**
+         * @return Where the time of the last renderFrame went (only fenceWait and acquire are updated when no image could be acquired)
+         */
+        [[nodiscard]] const FrameTimings &lastFrameTimings() const noexcept { return m_LastTimings; }
+
       private:
         std::shared_ptr<RenderSystem>       m_RenderSystem;
         std::array<F, MAX_FRAMES_IN_FLIGHT> m_FrameResources;
@@ -106,8 +161,10 @@ namespace game {
         vk::raii::CommandPool    m_CommandPool;
         vk::raii::CommandBuffers m_CommandBuffers;
 
-        uint32_t m_CurrentFrame      = 0;
-        uint32_t m_CurrentImageIndex = 0;
+        uint32_t     m_CurrentFrame      = 0;
+        uint32_t     m_CurrentImageIndex = 0;
+        uint64_t     m_FramesSubmitted   = 0;
+        FrameTimings m_LastTimings{};
     };
 
 } // namespace game
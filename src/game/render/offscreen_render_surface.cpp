@@ -0,0 +1,60 @@
+//
+// Created by andy on 7/9/2025.
+//
+
+#include "offscreen_render_surface.hpp"
+
+namespace game {
+    OffscreenRenderSurface::OffscreenRenderSurface(std::shared_ptr<RenderDevice> renderDevice, const vk::Extent2D extent, const vk::Format format)
+        : m_RenderDevice(std::move(renderDevice)), m_Allocator(std::make_unique<Allocator>(m_RenderDevice)), m_Format(format), m_Extent(extent) {
+        vk::ImageCreateInfo createInfo{};
+        createInfo.setImageType(vk::ImageType::e2D)
+            .setFormat(m_Format)
+            .setExtent(vk::Extent3D(m_Extent, 1))
+            .setMipLevels(1)
+            .setArrayLayers(1)
+            .setSamples(vk::SampleCountFlagBits::e1)
+            .setTiling(vk::ImageTiling::eOptimal)
+            .setUsage(vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc) // src so frames can be read back
+            .setSharingMode(vk::SharingMode::eExclusive)
+            .setInitialLayout(vk::ImageLayout::eUndefined);
+
+        m_Ring.reserve(IMAGE_COUNT);
+        m_Images.reserve(IMAGE_COUNT);
+        for (uint32_t i = 0; i < IMAGE_COUNT; i++) {
+            m_Ring.push_back(m_Allocator->createImageRawUnique(createInfo, MemoryUsage::AutoPreferDevice));
+            m_Images.push_back(m_Ring.back()->image);
+        }
+    }
+
+    OffscreenRenderSurface::~OffscreenRenderSurface() {
+        m_RenderDevice->device().waitIdle(); // the last frames may still be rendering into the ring
+    }
+
+    std::optional<std::tuple<vk::Image, uint32_t>> OffscreenRenderSurface::acquireNextImage(const vk::Semaphore semaphore) {
+        const auto index = m_Next;
+        m_Next           = (m_Next + 1) % IMAGE_COUNT;
+
+        // the image is free already (see the class comment), this only signals the semaphore the frame's submit waits on
+        vk::SubmitInfo submitInfo{};
+        submitInfo.setSignalSemaphores(semaphore);
+        m_RenderDevice->mainQueue().submit(submitInfo);
+
+        return std::make_tuple(m_Images[index], index);
+    }
+
+    bool OffscreenRenderSurface::checkRebuildSwapchain() {
+        return false;
+    }
+
+    void OffscreenRenderSurface::present([[maybe_unused]] const uint32_t index, const vk::Semaphore wait) {
+        // nothing to show the image on, but the wait has to be consumed so the semaphore can be signalled again next time the frame comes around
+        constexpr vk::PipelineStageFlags mask = vk::PipelineStageFlagBits::eAllCommands;
+
+        vk::SubmitInfo submitInfo{};
+        submitInfo.setWaitSemaphores(wait);
+        submitInfo.setWaitDstStageMask(mask);
+        m_RenderDevice->mainQueue().submit(submitInfo);
+        m_Presented++;
+    }
+} // namespace game
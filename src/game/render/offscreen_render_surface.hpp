@@ -0,0 +1,71 @@
+//
+// Created by andy on 7/9/2025.
+//
+
+#pragma once
+
+#include "game/render/allocator.hpp"
+#include "game/render/render_surface.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace game {
+    /**
+     * @brief A render surface without a window: a ring of offscreen images, handed out in turn.
+     *
+     * This lets the renderer run where there's no display to present to (CI boxes with a software vulkan driver, frame benchmarks). There's no presentation engine to signal
+     * and wait on the frame manager's semaphores, so acquiring and presenting each submit an empty batch to the main queue which does it instead. The ring has more images
+     * than frames in flight, so an image is never handed out again before the frame that last rendered into it has been waited on.
+     *
+     * The device still needs VK_KHR_swapchain (the renderer leaves images in the present layout), which every driver including the software ones has.
+     */
+    class OffscreenRenderSurface final : public RenderSurface {
+      public:
+        static constexpr uint32_t IMAGE_COUNT = 3;
+
+        /**
+         * @param renderDevice The device to create the images on
+         * @param extent The size of the images
+         * @param format The format of the images (the format window surfaces usually prefer by default, so frames cost about the same as on screen)
+         */
+        OffscreenRenderSurface(std::shared_ptr<RenderDevice> renderDevice, vk::Extent2D extent, vk::Format format = vk::Format::eB8G8R8A8Srgb);
+        ~OffscreenRenderSurface() override;
+
+        OffscreenRenderSurface(const OffscreenRenderSurface &other)                = delete;
+        OffscreenRenderSurface(OffscreenRenderSurface &&other) noexcept            = delete;
+        OffscreenRenderSurface &operator=(const OffscreenRenderSurface &other)     = delete;
+        OffscreenRenderSurface &operator=(OffscreenRenderSurface &&other) noexcept = delete;
+
+        [[nodiscard]] inline const std::vector<vk::Image> &images() const noexcept override { return m_Images; }
+
+        [[nodiscard]] inline vk::Format format() const noexcept override { return m_Format; }
+
+        [[nodiscard]] inline vk::Extent2D extent() const noexcept override { return m_Extent; }
+
+        std::optional<std::tuple<vk::Image, uint32_t>> acquireNextImage(vk::Semaphore semaphore) override;
+
+        /**
+         * @return false, the images never go out of date
+         */
+        bool checkRebuildSwapchain() override;
+
+        void present(uint32_t index, vk::Semaphore wait) override;
+
+        /**
+         * @return How many images have been presented
+         */
+        [[nodiscard]] inline uint64_t presented() const noexcept { return m_Presented; }
+
+      private:
+        std::shared_ptr<RenderDevice>          m_RenderDevice;
+        std::unique_ptr<Allocator>             m_Allocator;
+        std::vector<std::unique_ptr<RawImage>> m_Ring; // after the allocator, so the images are freed first
+        std::vector<vk::Image>                 m_Images;
+
+        vk::Format   m_Format;
+        vk::Extent2D m_Extent;
+        uint32_t     m_Next      = 0;
+        uint64_t     m_Presented = 0;
+    };
+} // namespace game
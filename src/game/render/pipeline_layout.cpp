@@ -12,6 +12,16 @@ namespace game {
     )
         : Asset(id, name), m_RenderDevice(renderDevice), m_PipelineLayout(m_RenderDevice->device(), vk::PipelineLayoutCreateInfo({}, descriptorSetLayouts, pushConstantRanges)) {}
 
+    bool PipelineLayout::swapContents(AssetBase &other) {
+        auto *layout = assetCast<PipelineLayout>(&other);
+        if (layout == nullptr)
+            return false;
+
+        std::swap(m_RenderDevice, layout->m_RenderDevice);
+        std::swap(m_PipelineLayout, layout->m_PipelineLayout);
+        return true;
+    }
+
     PipelineLayout *PipelineLayoutLoader::load(
         const nlohmann::json &json, const std::nullptr_t &options, asset_id_t id, const std::string &name, const AssetLoaderContext &loaderContext
     ) const {
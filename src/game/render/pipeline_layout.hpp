@@ -22,6 +22,10 @@ namespace game {
             cmd.pushConstants<T>(m_PipelineLayout, stageFlags, offset, values);
         };
 
+        bool swapContents(AssetBase &other) override;
+
+        [[nodiscard]] inline AssetFootprint footprint() const noexcept override { return {sizeof(PipelineLayout), 0}; }
+
 
       private:
         std::shared_ptr<RenderDevice> m_RenderDevice;
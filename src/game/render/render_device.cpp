@@ -4,9 +4,10 @@
 
 #include "render_device.hpp"
 #include <GLFW/glfw3.h>
+#include <stdexcept>
 
 namespace game {
-    RenderDevice::RenderDevice() {
+    RenderDevice::RenderDevice(const bool headless) : m_Headless(headless) {
         {
             vk::InstanceCreateInfo createInfo{};
             vk::ApplicationInfo    appInfo{};
@@ -14,14 +15,19 @@ namespace game {
 
             createInfo.setPApplicationInfo(&appInfo);
 
-            uint32_t     count;
-            const char **extensions = glfwGetRequiredInstanceExtensions(&count);
-            createInfo.setPpEnabledExtensionNames(extensions);
-            createInfo.setEnabledExtensionCount(count);
+            if (!m_Headless) { // headless devices have no surfaces, so they need no surface extensions
+                uint32_t     count;
+                const char **extensions = glfwGetRequiredInstanceExtensions(&count);
+                createInfo.setPpEnabledExtensionNames(extensions);
+                createInfo.setEnabledExtensionCount(count);
+            }
             m_Instance = vk::raii::Instance(m_Context, createInfo);
         }
 
-        m_PhysicalDevice = m_Instance.enumeratePhysicalDevices()[0];
+        const auto physicalDevices = m_Instance.enumeratePhysicalDevices();
+        if (physicalDevices.empty())
+            throw std::runtime_error("No vulkan devices");
+        m_PhysicalDevice = physicalDevices[0];
 
         {
             auto queueFamilyProperties = m_PhysicalDevice.getQueueFamilyProperties();
@@ -30,12 +36,12 @@ namespace game {
                 if (m_MainFamily == UINT32_MAX && props.queueFlags & vk::QueueFlagBits::eGraphics) {
                     m_MainFamily = i;
 
-                    if (glfwGetPhysicalDevicePresentationSupport(*m_Instance, *m_PhysicalDevice, i)) {
+                    if (m_Headless || glfwGetPhysicalDevicePresentationSupport(*m_Instance, *m_PhysicalDevice, i)) {
                         m_PresentFamily = i;
                     }
                 }
 
-                if (m_PresentFamily == UINT32_MAX && glfwGetPhysicalDevicePresentationSupport(*m_Instance, *m_PhysicalDevice, i)) {
+                if (!m_Headless && m_PresentFamily == UINT32_MAX && glfwGetPhysicalDevicePresentationSupport(*m_Instance, *m_PhysicalDevice, i)) {
                     m_PresentFamily = i;
                 }
 
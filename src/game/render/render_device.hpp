@@ -12,7 +12,11 @@ namespace game {
 
     class RenderDevice {
       public:
-        RenderDevice();
+        /**
+         * @param headless Make a device that never presents to a window (see OffscreenRenderSurface). It doesn't need glfw, or a display to exist, and presents on the main
+         * queue.
+         */
+        explicit RenderDevice(bool headless = false);
         ~RenderDevice();
 
         inline const vk::raii::Instance &instance() const noexcept { return m_Instance; };
@@ -33,12 +37,15 @@ namespace game {
 
         inline const std::optional<vk::raii::Queue> &exclusiveTransferQueue() const noexcept { return m_ExclusiveTransferQueue; };
 
+        inline bool headless() const noexcept { return m_Headless; };
+
         template <std::ranges::contiguous_range R>
         void resetFences(R &&fences) const {
             m_Device.resetFences(std::forward<R>(fences));
         }
 
       private:
+        bool                     m_Headless;
         vk::raii::Context        m_Context;
         vk::raii::Instance       m_Instance{nullptr};
         vk::raii::PhysicalDevice m_PhysicalDevice{nullptr};
@@ -5,7 +5,7 @@
 #include "render_surface.hpp"
 
 namespace game {
-    RenderSurface::RenderSurface(std::shared_ptr<Window> window, std::shared_ptr<RenderDevice> renderDevice)
+    SwapchainRenderSurface::SwapchainRenderSurface(std::shared_ptr<Window> window, std::shared_ptr<RenderDevice> renderDevice)
         : m_Window(std::move(window)), m_RenderDevice(std::move(renderDevice)) {
         VkSurfaceKHR surf;
         glfwCreateWindowSurface(*m_RenderDevice->instance(), m_Window->window(), nullptr, &surf);
@@ -14,7 +14,7 @@ namespace game {
         createSwapchain();
     }
 
-    RenderSurface::~RenderSurface() = default;
+    SwapchainRenderSurface::~SwapchainRenderSurface() = default;
 
     inline vk::SurfaceFormatKHR selectSurfaceFormat(const std::vector<vk::SurfaceFormatKHR> &formats) {
         auto fallback = formats[0];
@@ -38,7 +38,7 @@ namespace game {
         return vk::PresentModeKHR::eFifo;
     }
 
-    void RenderSurface::createSwapchain() {
+    void SwapchainRenderSurface::createSwapchain() {
         auto capabilities   = m_RenderDevice->physicalDevice().getSurfaceCapabilitiesKHR(m_Surface);
         auto presentModes   = m_RenderDevice->physicalDevice().getSurfacePresentModesKHR(m_Surface);
         auto surfaceFormats = m_RenderDevice->physicalDevice().getSurfaceFormatsKHR(m_Surface);
@@ -92,7 +92,7 @@ namespace game {
         m_Images    = m_Swapchain.getImages();
     }
 
-    std::optional<std::tuple<vk::Image, uint32_t>> RenderSurface::acquireNextImage(vk::Semaphore semaphore) {
+    std::optional<std::tuple<vk::Image, uint32_t>> SwapchainRenderSurface::acquireNextImage(vk::Semaphore semaphore) {
         try {
             const auto [res, index] = m_Swapchain.acquireNextImage(UINT64_MAX, semaphore);
             if (res != vk::Result::eSuccess)
@@ -105,7 +105,7 @@ namespace game {
         }
     }
 
-    bool RenderSurface::checkRebuildSwapchain() {
+    bool SwapchainRenderSurface::checkRebuildSwapchain() {
         if (m_NeedsRebuild) {
             m_RenderDevice->device().waitIdle(); // wait idle so we don't step on any toes
             createSwapchain();
@@ -115,7 +115,7 @@ namespace game {
         return false;
     }
 
-    void RenderSurface::present(uint32_t index, vk::Semaphore wait) {
+    void SwapchainRenderSurface::present(uint32_t index, vk::Semaphore wait) {
         vk::PresentInfoKHR presentInfo{};
         presentInfo.setSwapchains(*m_Swapchain);
         presentInfo.setImageIndices(index);
@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <memory>
 #include <optional>
+#include <tuple>
+#include <vector>
 
 #include <GLFW/glfw3.h>
 #include <vulkan/vulkan.hpp>
@@ -15,10 +18,47 @@
 
 namespace game {
 
+    /**
+     * @brief What the frame manager renders into: a set of images, acquired one at a time and presented once rendered.
+     */
     class RenderSurface {
     public:
-        RenderSurface(std::shared_ptr<Window> window, std::shared_ptr<RenderDevice> renderDevice);
-        ~RenderSurface();
+        virtual ~RenderSurface() = default;
+
+        [[nodiscard]] virtual const std::vector<vk::Image> &images() const noexcept = 0;
+
+        [[nodiscard]] virtual vk::Format format() const noexcept = 0;
+
+        [[nodiscard]] virtual vk::Extent2D extent() const noexcept = 0;
+
+        /**
+         * @brief Take the next image to render into
+         * @param semaphore Signalled once the image can be written to
+         * @return The image and its index in images(), or an empty optional if the images have to be rebuilt first
+         */
+        virtual std::optional<std::tuple<vk::Image, uint32_t>> acquireNextImage(vk::Semaphore semaphore) = 0;
+
+        /**
+         * @brief Rebuild the images if they went out of date
+         * @return If they were rebuilt (and images() may have changed)
+         */
+        virtual bool checkRebuildSwapchain() = 0;
+
+        /**
+         * @brief Hand a rendered image back
+         * @param index The image's index in images()
+         * @param wait Signalled once rendering into the image is done
+         */
+        virtual void present(uint32_t index, vk::Semaphore wait) = 0;
+    };
+
+    /**
+     * @brief A window's swapchain.
+     */
+    class SwapchainRenderSurface final : public RenderSurface {
+    public:
+        SwapchainRenderSurface(std::shared_ptr<Window> window, std::shared_ptr<RenderDevice> renderDevice);
+        ~SwapchainRenderSurface() override;
 
         void createSwapchain();
 
@@ -26,20 +66,20 @@ namespace game {
 
         inline const vk::raii::SwapchainKHR &swapchain() const noexcept { return m_Swapchain; }
 
-        inline const std::vector<vk::Image> &images() const noexcept { return m_Images; }
+        inline const std::vector<vk::Image> &images() const noexcept override { return m_Images; }
 
-        inline vk::Format format() const noexcept { return m_Format; }
+        inline vk::Format format() const noexcept override { return m_Format; }
 
         inline vk::ColorSpaceKHR colorSpace() const noexcept { return m_ColorSpace; }
 
         inline vk::PresentModeKHR presentMode() const noexcept { return m_PresentMode; }
 
-        inline vk::Extent2D extent() const noexcept { return m_Extent; }
+        inline vk::Extent2D extent() const noexcept override { return m_Extent; }
 
-        std::optional<std::tuple<vk::Image, uint32_t>> acquireNextImage(vk::Semaphore semaphore);
+        std::optional<std::tuple<vk::Image, uint32_t>> acquireNextImage(vk::Semaphore semaphore) override;
 
-        bool checkRebuildSwapchain();
-        void present(uint32_t index, vk::Semaphore wait);
+        bool checkRebuildSwapchain() override;
+        void present(uint32_t index, vk::Semaphore wait) override;
 
     private:
         std::shared_ptr<Window>       m_Window;
@@ -26,6 +26,7 @@ namespace game {
 
             m_Stages.push_back(createInfo.stage);
             m_StageFlags |= createInfo.stage;
+            m_CodeSize += createInfo.codeSize;
             m_ShadersI.push_back(m_Shaders[i++]);
         }
 
@@ -39,6 +40,26 @@ namespace game {
         cmd.bindShadersEXT(m_Stages, m_ShadersI);
     }
 
+    bool Shader::swapContents(AssetBase &other) {
+        auto *shader = assetCast<Shader>(&other);
+        if (shader == nullptr)
+            return false;
+
+        std::swap(m_Shaders, shader->m_Shaders);
+        std::swap(m_ShadersI, shader->m_ShadersI);
+        std::swap(m_IsLinked, shader->m_IsLinked);
+        std::swap(m_Stages, shader->m_Stages);
+        std::swap(m_StageFlags, shader->m_StageFlags);
+        std::swap(m_CodeSize, shader->m_CodeSize);
+        return true;
+    }
+
+    AssetFootprint Shader::footprint() const noexcept {
+        const auto cpu = sizeof(Shader) + m_Shaders.capacity() * sizeof(vk::raii::ShaderEXT) + m_ShadersI.capacity() * sizeof(vk::ShaderEXT) +
+                         m_Stages.capacity() * sizeof(vk::ShaderStageFlagBits);
+        return {cpu, m_CodeSize};
+    }
+
     static vk::ShaderStageFlags inferAllowedNext(const vk::ShaderStageFlagBits currentStage, vk::ShaderStageFlags stagesInLinkedShader = vk::ShaderStageFlags{0U}) {
         if (stagesInLinkedShader == vk::ShaderStageFlags{0U}) {
             stagesInLinkedShader = currentStage; // not linked
@@ -121,7 +142,7 @@ namespace game {
     UnlinkedShaderManifest UnlinkedShaderAssetLoader::loadManifest(
         const std::size_t size, const unsigned char *data, const std::nullptr_t &options, const asset_id_t id, const std::string &name, const AssetLoaderContext &loaderContext
     ) const {
-        nlohmann::json json = nlohmann::json::parse(data, data + size);
+        nlohmann::json json = asset_util::parseMetadata(size, data);
         if (!json.is_object())
             throw std::invalid_argument("Failed to parse unlinked shader '" + name + "': Metadata root is not a json object");
         const auto file  = json["file"].get<std::string>();
@@ -148,9 +169,11 @@ namespace game {
 
         // TODO: descriptor set layouts.
         //       descriptor set layouts is waiting on the asset manager + asset resolver to be set up
-        return UnlinkedShaderManifest(
+        UnlinkedShaderManifest manifest(
             UnlinkedShaderObjectOptions{PerShaderObjectOptions{stage, allowedNextFlags, entry, vk::ShaderCreateFlagsEXT{0U}}, GenericShaderObjectOptions{{}, pcrs}}, file
         );
+        manifest.name = asset_util::declaredName(json, name);
+        return manifest;
     }
 
     Shader *LinkedShaderAssetLoader::load(
@@ -174,7 +197,7 @@ namespace game {
     ) const {
         LinkedShaderManifest manifest{};
 
-        nlohmann::json json = nlohmann::json::parse(data, data + size);
+        nlohmann::json json = asset_util::parseMetadata(size, data);
         if (!json.is_object())
             throw std::invalid_argument("Invalid linked shader manifest: json root must be an object");
 
@@ -221,6 +244,7 @@ namespace game {
         // TODO: descriptor set layouts.
         //       descriptor set layouts is waiting on the asset manager + asset resolver to be set up
         manifest.genericOptions = {{}, pcrs};
+        manifest.name           = asset_util::declaredName(json, name);
 
         return manifest;
     }
@@ -48,6 +48,13 @@ namespace game {
 
         [[nodiscard]] inline const vk::ShaderEXT &operator*() const { return *m_Shaders[0]; };
 
+        bool swapContents(AssetBase &other) override;
+
+        /**
+         * @return The shader's own objects, and the size of its code as a stand in for what the driver keeps (which isn't queryable)
+         */
+        [[nodiscard]] AssetFootprint footprint() const noexcept override;
+
       private:
         vk::raii::ShaderEXTs       m_Shaders;
         std::vector<vk::ShaderEXT> m_ShadersI; // it's stupid but the command buffer won't accept an array of the raii shaders so I have to use a separate vector for these
@@ -57,6 +64,7 @@ namespace game {
         // stageFlags is best for validating shader bindings (make sure that we don't make a material with 2 fragment shaders since only one will be used)
         std::vector<vk::ShaderStageFlagBits> m_Stages;
         vk::ShaderStageFlags                 m_StageFlags{0U};
+        std::size_t                          m_CodeSize = 0;
     };
 
     /**
@@ -4,6 +4,8 @@
 
 #include "single_time_commands.hpp"
 
+#include "game/profiler.hpp"
+
 namespace game {
     SingleTimeCommands::SingleTimeCommands(std::shared_ptr<RenderDevice> renderDevice, uint32_t family, const vk::raii::Queue &queue)
         : m_RenderDevice(std::move(renderDevice)), m_CommandPool(m_RenderDevice->device(), vk::CommandPoolCreateInfo(vk::CommandPoolCreateFlagBits::eResetCommandBuffer, family)),
@@ -42,6 +44,7 @@ namespace game {
         const std::function<void(const vk::raii::CommandBuffer &cmd)> &f, std::optional<vk::SemaphoreSubmitInfo> waitSemaphore,
         std::optional<vk::SemaphoreSubmitInfo> signalSemaphore
     ) {
+        GAME_PROFILE_ZONE("SingleTimeCommands::runCommands");
         const auto commandBufferIndex                  = acquireCommandBuffer();
         const auto &[commandBuffer, availabilityFence] = m_CommandBuffers[commandBufferIndex];
         commandBuffer.reset();
@@ -63,6 +66,7 @@ namespace game {
         submitInfo.setCommandBufferInfos(cmdSubmit);
 
         m_Queue.submit2(submitInfo, availabilityFence);
+        m_InUse.push_back(commandBufferIndex); // handed back by pollInUse once the fence signals
     }
 
     std::size_t SingleTimeCommands::acquireCommandBuffer() {
@@ -4,9 +4,14 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
 #include <cstddef>
 #include <functional>
+#include <memory>
 #include <mutex>
 
 namespace game {
@@ -20,64 +25,207 @@ namespace game {
         return array_from_fn<T>(f, std::make_index_sequence<N>());
     }
 
-    // concurrent queue based on atomics (if the atomic types used are lock-free then this should be too).
+    /**
+     * @brief Bounded lock-free multi-producer multi-consumer queue (a ring of sequenced cells, after Dmitry Vyukov's bounded MPMC queue).
+     *
+     * Each cell carries a sequence number which says whose turn it is: producers claim the cell at the enqueue position once its sequence equals the position, consumers claim
+     * it once the sequence is one past the position, and the claim is a single CAS on the shared position. The positions live on their own cache lines so producers and
+     * consumers don't contend on the same line. Nothing is allocated after construction.
+     *
+     * @tparam T The element type (has to be default constructible, the ring is filled with empty values up front)
+     */
     template <typename T>
-    class concurrent_queue {
-        struct node {
-            T     value;
-            node *prev;
-            node *next;
+        requires(std::default_initializable<T> && std::movable<T>)
+    class bounded_mpmc_queue {
+        struct cell {
+            std::atomic<std::size_t> sequence;
+            T                        value;
         };
 
-        std::atomic<node *> head = nullptr;
-        std::atomic<node *> tail = nullptr;
+        std::size_t             m_Mask;
+        std::unique_ptr<cell[]> m_Cells;
+
+        alignas(64) std::atomic<std::size_t> m_EnqueuePos = 0;
+        alignas(64) std::atomic<std::size_t> m_DequeuePos = 0;
 
       public:
-        ~concurrent_queue() {
-            auto* head = this->head.load();
-            while (head) {
-                auto *p = head;
-                head    = head->next;
-                delete p;
+        /**
+         * @param capacity The number of elements the queue can hold (rounded up to a power of 2)
+         */
+        explicit bounded_mpmc_queue(const std::size_t capacity) : m_Mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1), m_Cells(new cell[m_Mask + 1]) {
+            for (std::size_t i = 0; i <= m_Mask; i++) {
+                m_Cells[i].sequence.store(i, std::memory_order::relaxed);
             }
         }
 
-        concurrent_queue() = default;
+        bounded_mpmc_queue(const bounded_mpmc_queue &other)                = delete;
+        bounded_mpmc_queue(bounded_mpmc_queue &&other) noexcept            = delete;
+        bounded_mpmc_queue &operator=(const bounded_mpmc_queue &other)     = delete;
+        bounded_mpmc_queue &operator=(bounded_mpmc_queue &&other) noexcept = delete;
 
-        concurrent_queue(const concurrent_queue &other)                = delete;
-        concurrent_queue(concurrent_queue &&other) noexcept            = default;
-        concurrent_queue &operator=(const concurrent_queue &other)     = delete;
-        concurrent_queue &operator=(concurrent_queue &&other) noexcept = default;
+        [[nodiscard]] std::size_t capacity() const noexcept { return m_Mask + 1; }
 
-        [[nodiscard]] bool empty() const noexcept { return head == nullptr; }
+        // only a snapshot when other threads are using the queue
+        [[nodiscard]] bool empty() const noexcept { return m_EnqueuePos.load(std::memory_order::acquire) == m_DequeuePos.load(std::memory_order::acquire); }
 
-        // 2 atomic ops per call
-        void enqueue(T value) {
-            node *node_  = new node();
-            node_->value = std::move(value);
-            node_->prev  = tail.exchange(node_);
+        /**
+         * @brief Add an element, unless the queue is full
+         * @return If the element was added (it is only moved from if it was)
+         */
+        bool try_enqueue(T &&value) {
+            cell *c;
+            auto  pos = m_EnqueuePos.load(std::memory_order::relaxed);
+            while (true) {
+                c              = &m_Cells[pos & m_Mask];
+                const auto seq = c->sequence.load(std::memory_order::acquire);
+                const auto dif = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+                if (dif == 0) {
+                    if (m_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order::relaxed))
+                        break;
+                } else if (dif < 0) {
+                    return false; // the consumer of this cell's last lap hasn't finished with it, so we're a full lap ahead
+                } else {
+                    pos = m_EnqueuePos.load(std::memory_order::relaxed); // another producer took this position
+                }
+            }
 
-            // set the head to node_ if the head is nullptr right now (first node). otherwise, we need to update the previous node's next
-            if (node *np = nullptr; !head.compare_exchange_strong(np, node_)) {
-                node_->prev->next = node_;
+            c->value = std::move(value);
+            c->sequence.store(pos + 1, std::memory_order::release);
+            return true;
+        }
+
+        bool try_enqueue(const T &value) {
+            T copy = value;
+            return try_enqueue(std::move(copy));
+        }
+
+        /**
+         * @brief Take the oldest element, unless the queue is empty
+         * @return If an element was taken (into out)
+         */
+        bool try_dequeue(T &out) {
+            cell *c;
+            auto  pos = m_DequeuePos.load(std::memory_order::relaxed);
+            while (true) {
+                c              = &m_Cells[pos & m_Mask];
+                const auto seq = c->sequence.load(std::memory_order::acquire);
+                const auto dif = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+                if (dif == 0) {
+                    if (m_DequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order::relaxed))
+                        break;
+                } else if (dif < 0) {
+                    return false; // nothing has been written here this lap
+                } else {
+                    pos = m_DequeuePos.load(std::memory_order::relaxed); // another consumer took this position
+                }
             }
+
+            out = std::move(c->value);
+            c->sequence.store(pos + m_Mask + 1, std::memory_order::release); // free for the producer one lap later
+            return true;
         }
+    };
+
+    /**
+     * @brief Unbounded multi-producer multi-consumer queue (Michael and Scott's two-lock queue) which recycles its nodes.
+     *
+     * Producers only take the tail lock and consumers only take the head lock, so one enqueue and one dequeue always run in parallel. Dequeued nodes go onto a lock-free free
+     * list and enqueues take from it before allocating, so once the queue has grown to its working size it stops allocating. The free list only ever has one thread popping
+     * from it (whoever holds the tail lock), which is what keeps it safe from ABA without tagged pointers.
+     *
+     * @tparam T The element type
+     */
+    template <typename T>
+        requires(std::default_initializable<T> && std::movable<T>)
+    class unbounded_mpmc_queue {
+        struct node {
+            T                   value;
+            std::atomic<node *> next = nullptr;
+        };
 
-        // don't call this if the queue is not empty()
-        // 2-3 atomic ops per call (2 unless the head and tail are the same, in which case we have an extra store).
-        T dequeue() {
-            node *node_ = head.exchange(head.load()->next);
-            if (node_->next != nullptr) { // no weird locking necessary here
-                node_->next->prev = nullptr;
-            } else {
-                tail.store(nullptr);
+        alignas(64) std::mutex m_HeadMutex;
+        node *m_Head; // a dummy node, the front element is m_Head->next
+
+        alignas(64) std::mutex m_TailMutex;
+        node *m_Tail;
+
+        alignas(64) std::atomic<node *> m_Pool = nullptr;
+
+        node *acquireNode() { // m_TailMutex must be held
+            auto *n = m_Pool.load(std::memory_order::acquire);
+            while (n != nullptr && !m_Pool.compare_exchange_weak(n, n->next.load(std::memory_order::relaxed), std::memory_order::acquire)) {
             }
+            if (n == nullptr)
+                return new node();
+            n->next.store(nullptr, std::memory_order::relaxed);
+            return n;
+        }
 
-            // move value out of node_ before we destroy node_
-            T value = std::move(node_->value);
-            delete node_;
+        void releaseNode(node *n) noexcept {
+            auto *top = m_Pool.load(std::memory_order::relaxed);
+            do {
+                n->next.store(top, std::memory_order::relaxed);
+            } while (!m_Pool.compare_exchange_weak(top, n, std::memory_order::release, std::memory_order::relaxed));
+        }
 
-            return std::move(value);
+        static void deleteList(node *n) noexcept {
+            while (n != nullptr) {
+                auto *next = n->next.load(std::memory_order::relaxed);
+                delete n;
+                n = next;
+            }
+        }
+
+      public:
+        /**
+         * @param reserve The number of nodes to allocate up front
+         */
+        explicit unbounded_mpmc_queue(const std::size_t reserve = 0) : m_Head(new node()), m_Tail(m_Head) {
+            for (std::size_t i = 0; i < reserve; i++) {
+                releaseNode(new node());
+            }
+        }
+
+        ~unbounded_mpmc_queue() {
+            deleteList(m_Head);
+            deleteList(m_Pool.load(std::memory_order::relaxed));
+        }
+
+        unbounded_mpmc_queue(const unbounded_mpmc_queue &other)                = delete;
+        unbounded_mpmc_queue(unbounded_mpmc_queue &&other) noexcept            = delete;
+        unbounded_mpmc_queue &operator=(const unbounded_mpmc_queue &other)     = delete;
+        unbounded_mpmc_queue &operator=(unbounded_mpmc_queue &&other) noexcept = delete;
+
+        [[nodiscard]] bool empty() {
+            std::lock_guard lock(m_HeadMutex);
+            return m_Head->next.load(std::memory_order::acquire) == nullptr;
+        }
+
+        void enqueue(T value) {
+            std::lock_guard lock(m_TailMutex);
+            auto           *n = acquireNode();
+            n->value          = std::move(value);
+            m_Tail->next.store(n, std::memory_order::release); // publishes the value to the consumer that reads this link
+            m_Tail = n;
+        }
+
+        /**
+         * @brief Take the oldest element, unless the queue is empty
+         * @return If an element was taken (into out)
+         */
+        bool try_dequeue(T &out) {
+            node *old;
+            {
+                std::lock_guard lock(m_HeadMutex);
+                old        = m_Head;
+                auto *next = old->next.load(std::memory_order::acquire);
+                if (next == nullptr)
+                    return false;
+                out    = std::move(next->value);
+                m_Head = next; // becomes the new dummy
+            }
+            releaseNode(old); // nobody else can reach the old dummy now
+            return true;
         }
     };
 } // namespace game
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""Build the sqlite asset database (the path -> source index) for an assets directory.
+
+Every file in the directory gets a row (source_kind 1 if it is a compressed asset, otherwise 0), and every asset inside the
+given packs gets a row with source_kind 2 pointing at its pack. Rows for packs are written last, so a packed asset wins over a
+loose file with the same path. The schema matches asset_format.md.
+"""
+
+import argparse
+import os
+import sqlite3
+import struct
+import sys
+import uuid
+
+PACK_MAGIC = 0x50414754  # "TGAP"
+PACK_HEADER = struct.Struct("<IIIIQQ")
+PACK_TOC_ENTRY = struct.Struct("<QQQII")
+COMPRESSED_MAGIC = 0x5A434754  # "TGCZ"
+
+SOURCE_FILE = 0
+SOURCE_COMPRESSED = 1
+SOURCE_PACK = 2
+
+
+def is_compressed(path: str) -> bool:
+    with open(path, "rb") as f:
+        magic = f.read(4)
+    return len(magic) == 4 and struct.unpack("<I", magic)[0] == COMPRESSED_MAGIC
+
+
+def pack_paths(pack: str) -> list[str]:
+    with open(pack, "rb") as f:
+        contents = f.read()
+    magic, _, _, bucket_count, toc_offset, strings_offset = PACK_HEADER.unpack_from(contents)
+    if magic != PACK_MAGIC:
+        raise ValueError(f"{pack} is not an asset pack")
+
+    paths = []
+    for i in range(bucket_count):
+        path_hash, _, _, path_offset, path_length = PACK_TOC_ENTRY.unpack_from(contents, toc_offset + i * PACK_TOC_ENTRY.size)
+        if path_hash != 0:
+            start = strings_offset + path_offset
+            paths.append(contents[start:start + path_length].decode("utf-8"))
+    return paths
+
+
+def build(root: str, output: str, packs: list[str]) -> None:
+    skip = {os.path.abspath(output), *(os.path.abspath(p) for p in packs)}
+    rows = []
+    for directory, _, files in os.walk(root):
+        for name in files:
+            full = os.path.join(directory, name)
+            if name.startswith(".") or os.path.abspath(full) in skip or name.endswith((".db", ".db-journal")):
+                continue
+            rel = os.path.relpath(full, root).replace(os.sep, "/")
+            rows.append((rel, SOURCE_COMPRESSED if is_compressed(full) else SOURCE_FILE, rel))
+
+    for pack in packs:
+        pack_rel = os.path.relpath(pack, root).replace(os.sep, "/")
+        rows += [(path, SOURCE_PACK, pack_rel) for path in pack_paths(pack)]
+
+    if os.path.exists(output):
+        os.remove(output)
+    db = sqlite3.connect(output)
+    db.execute("CREATE TABLE assets (id UUID PRIMARY KEY, path VARCHAR(255) UNIQUE NOT NULL, source_kind INTEGER NOT NULL, source_path VARCHAR(255) NOT NULL)")
+    db.executemany(
+        "INSERT INTO assets (id, path, source_kind, source_path) VALUES (?, ?, ?, ?) "
+        "ON CONFLICT(path) DO UPDATE SET source_kind = excluded.source_kind, source_path = excluded.source_path",
+        [(uuid.uuid4().hex, *row) for row in rows],
+    )
+    db.commit()
+    db.close()
+
+    print(f"indexed {len(rows)} asset sources into {output}")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("assets", help="the assets directory")
+    parser.add_argument("output", help="the database file to write")
+    parser.add_argument("--pack", action="append", default=[], help="an asset pack (inside the assets directory) to index")
+    args = parser.parse_args()
+    build(args.assets, args.output, args.pack)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
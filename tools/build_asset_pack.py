@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""Build a single-file asset pack out of an assets directory.
+
+The layout matches game/asset/asset_pack.hpp:
+
+    header (32 bytes)
+    table of contents (bucket_count * 32 bytes, open-addressed by FNV-1a hash of the asset path)
+    string table (asset paths, relative to the assets directory with forward slashes)
+    asset data (each entry aligned to 16 bytes)
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+MAGIC = 0x50414754  # "TGAP"
+VERSION = 1
+HEADER = struct.Struct("<IIIIQQ")
+TOC_ENTRY = struct.Struct("<QQQII")
+DATA_ALIGNMENT = 16
+
+
+def asset_pack_hash(path: str) -> int:
+    h = 0xCBF29CE484222325
+    for c in path.encode("utf-8"):
+        h ^= c
+        h = (h * 0x100000001B3) & 0xFFFFFFFFFFFFFFFF
+    return 1 if h == 0 else h
+
+
+def align(value: int, alignment: int) -> int:
+    return (value + alignment - 1) & ~(alignment - 1)
+
+
+def collect(root: str, exclude: set[str]) -> list[str]:
+    paths = []
+    for directory, _, files in os.walk(root):
+        for name in files:
+            full = os.path.join(directory, name)
+            rel = os.path.relpath(full, root).replace(os.sep, "/")
+            if rel in exclude or name.startswith("."):
+                continue
+            paths.append(rel)
+    return sorted(paths)
+
+
+def build(root: str, output: str) -> None:
+    paths = collect(root, {os.path.relpath(output, root).replace(os.sep, "/")})
+
+    bucket_count = 1
+    while bucket_count < len(paths) * 2:  # keep the load factor at or below 0.5
+        bucket_count *= 2
+    if bucket_count <= len(paths):
+        bucket_count *= 2
+
+    toc_offset = HEADER.size
+    strings_offset = toc_offset + bucket_count * TOC_ENTRY.size
+
+    strings = bytearray()
+    path_locations = {}
+    for path in paths:
+        encoded = path.encode("utf-8")
+        path_locations[path] = (len(strings), len(encoded))
+        strings += encoded
+
+    data = bytearray()
+    data_offset = align(strings_offset + len(strings), DATA_ALIGNMENT)
+    buckets = [None] * bucket_count
+    for path in paths:
+        with open(os.path.join(root, path), "rb") as f:
+            contents = f.read()
+
+        offset = data_offset + len(data)
+        data += contents
+        data += b"\0" * (align(len(data), DATA_ALIGNMENT) - len(data))
+
+        h = asset_pack_hash(path)
+        i = h & (bucket_count - 1)
+        while buckets[i] is not None:
+            i = (i + 1) & (bucket_count - 1)
+        buckets[i] = (h, offset, len(contents), *path_locations[path])
+
+    with open(output, "wb") as out:
+        out.write(HEADER.pack(MAGIC, VERSION, len(paths), bucket_count, toc_offset, strings_offset))
+        for bucket in buckets:
+            out.write(TOC_ENTRY.pack(*bucket) if bucket is not None else b"\0" * TOC_ENTRY.size)
+        out.write(strings)
+        out.write(b"\0" * (data_offset - strings_offset - len(strings)))
+        out.write(data)
+
+    print(f"packed {len(paths)} assets into {output}")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("assets", help="the assets directory")
+    parser.add_argument("output", help="the pack file to write")
+    args = parser.parse_args()
+    build(args.assets, args.output)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+"""Compress an asset into the block-compressed format read by game/asset/compressed_asset.hpp.
+
+The asset is split into fixed-size blocks which are each compressed as an independent raw DEFLATE stream, so the game can decompress them in parallel.
+Compressed assets keep their original name; the game detects them by their magic number.
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+MAGIC = 0x5A434754  # "TGCZ"
+VERSION = 1
+HEADER = struct.Struct("<IIIIQ")
+BLOCK = struct.Struct("<QII")
+
+
+def compress(data: bytes, block_size: int, level: int) -> bytes:
+    chunks = [data[i:i + block_size] for i in range(0, len(data), block_size)] or [b""]
+
+    compressed = []
+    for chunk in chunks:
+        compressor = zlib.compressobj(level, zlib.DEFLATED, -15)  # negative window bits = raw deflate, no zlib header
+        compressed.append(compressor.compress(chunk) + compressor.flush())
+
+    offset = HEADER.size + BLOCK.size * len(chunks)
+    out = bytearray(HEADER.pack(MAGIC, VERSION, len(chunks), block_size, len(data)))
+    for chunk, block in zip(chunks, compressed):
+        out += BLOCK.pack(offset, len(block), len(chunk))
+        offset += len(block)
+    for block in compressed:
+        out += block
+    return bytes(out)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", help="the asset to compress")
+    parser.add_argument("output", nargs="?", help="where to write the compressed asset (defaults to replacing the input)")
+    parser.add_argument("--block-size", type=int, default=256 * 1024, help="uncompressed size of each block (default 256KiB)")
+    parser.add_argument("--level", type=int, default=9, help="deflate compression level (default 9)")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+    if data[:4] == struct.pack("<I", MAGIC):
+        print(f"{args.input} is already compressed", file=sys.stderr)
+        return 1
+
+    result = compress(data, args.block_size, args.level)
+    with open(args.output or args.input, "wb") as f:
+        f.write(result)
+
+    print(f"{args.input}: {len(data)} -> {len(result)} bytes in {(len(data) + args.block_size - 1) // args.block_size or 1} blocks")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())